@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+# -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+
+"""Scaling benchmark suite.
+
+Runs the scenarios at increasing scale, one at a time so that they do not
+compete for the CPU, and collects the profile each one writes with --profile:
+setup and run times, events per second, simulated seconds per wall second and
+peak memory. The results are saved as JSON and compared against a baseline
+(benchmarks/baseline.json) so that performance regressions are caught.
+
+Example:
+
+    ./bench.py --repeat 3                 # Run the suite and compare
+    ./bench.py --repeat 3 --save-baseline # Make the results the new baseline
+"""
+
+import argparse
+import datetime
+import json
+import os
+import platform
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TOP = os.path.dirname(os.path.abspath(__file__))
+BUILD = os.path.join(TOP, 'build')
+BASELINE = os.path.join(TOP, 'benchmarks', 'baseline.json')
+
+# The consumers tracking their Interests in flight with a ring instead of containers
+TRACKING = 'ns3::ndn::ConsumerSrc::InFlightTracking'
+
+# Short lapses keep the longest runs in the order of a minute
+SUITE = (
+    [('linear-simple', {'nComms': n, 'lapse': '2s'}) for n in (1, 2, 4, 8, 16)]
+    + [('parking-lot', {'nComms': n, 'lapse': '2s'}) for n in (2, 4, 8, 16)]
+    + [('parking-lot', {'nComms': n, 'lapse': '2s', TRACKING: 'RING'}) for n in (2, 4, 8, 16)]
+    + [('cascade-simple', {'payload': p, 'lapse': '5s'}) for p in (500, 1000, 1450)]
+)
+
+# Metric, whether higher is better and the smallest baseline value worth comparing
+METRICS = [
+    ('events_per_second', True, 0),
+    ('simulated_per_wall_second', True, 0),
+    ('setup_seconds', False, 0.1),
+    ('peak_rss_kb', False, 0),
+]
+
+######################################################################
+######################################################################
+######################################################################
+
+parser = argparse.ArgumentParser(description='Scenario scaling benchmarks',
+                                 formatter_class=argparse.RawDescriptionHelpFormatter,
+                                 epilog=__doc__)
+parser.add_argument('-o', '--output', default=os.path.join(TOP, 'results', 'bench.json'),
+                    help='Results file (default: results/bench.json)')
+parser.add_argument('-b', '--baseline', default=BASELINE,
+                    help='Baseline to compare with (default: benchmarks/baseline.json)')
+parser.add_argument('--save-baseline', action='store_true',
+                    help='Store the results as the new baseline instead of comparing')
+parser.add_argument('-t', '--tolerance', type=float, default=0.1,
+                    help='Relative change of a metric reported as a regression (default: 0.1)')
+parser.add_argument('-r', '--repeat', type=int, default=1,
+                    help='Runs of each case. The fastest one is kept (default: 1)')
+parser.add_argument('-q', '--quick', action='store_true',
+                    help='Only run the two smallest cases of each scenario')
+parser.add_argument('--scheduler', action='append',
+                    help='Run every case with this event scheduler: map, heap, list, calendar or '
+                    'ladder (can be repeated to compare them)')
+parser.add_argument('-s', '--scenario', action='append',
+                    help='Only run this scenario (can be repeated)')
+
+args = parser.parse_args()
+
+if args.repeat < 1:
+    parser.error('--repeat must be positive')
+
+######################################################################
+######################################################################
+######################################################################
+
+def case_key(scenario, params):
+    return scenario + ' ' + ' '.join('%s=%s' % item for item in sorted(params.items()))
+
+def select_cases():
+    cases = [case for case in SUITE if not args.scenario or case[0] in args.scenario]
+    if args.quick:
+        seen = {}
+        quick = []
+        for scenario, params in cases:
+            seen[scenario] = seen.get(scenario, 0) + 1
+            if seen[scenario] <= 2:
+                quick.append((scenario, params))
+        cases = quick
+    if args.scheduler:
+        cases = [(scenario, dict(params, scheduler=scheduler))
+                 for scenario, params in cases for scheduler in args.scheduler]
+    return cases
+
+def run_case(scenario, params):
+    "Runs a case in a scratch directory and returns its profile"
+    directory = tempfile.mkdtemp(prefix='bench-')
+    try:
+        # Scenarios look for their default topology files in scenarios/
+        os.symlink(os.path.join(TOP, 'scenarios'), os.path.join(directory, 'scenarios'))
+        cmdline = [os.path.join(BUILD, scenario), '--profile=profile.json']
+        cmdline += ['--%s=%s' % item for item in sorted(params.items())]
+        code = subprocess.call(cmdline, cwd=directory,
+                               stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        if code != 0:
+            raise RuntimeError('%s failed with code %d' % (' '.join(cmdline), code))
+        with open(os.path.join(directory, 'profile.json')) as profile:
+            return json.load(profile)
+    finally:
+        shutil.rmtree(directory)
+
+def git_revision():
+    try:
+        return subprocess.check_output(['git', 'describe', '--always', '--dirty'], cwd=TOP,
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return 'unknown'
+
+def compare(results, baseline):
+    "Prints the change of every metric and returns the number of regressions"
+    reference = {case['key']: case for case in baseline['cases']}
+    regressions = 0
+
+    print('\nComparison with the baseline of %s (%s, %s)'
+          % (baseline.get('date', '?'), baseline.get('revision', '?'), baseline.get('host', '?')))
+    for case in results['cases']:
+        old = reference.get(case['key'])
+        if old is None:
+            print('%-40s not in the baseline' % case['key'])
+            continue
+
+        changes = []
+        for metric, higher_is_better, floor in METRICS:
+            if old[metric] <= floor:
+                continue
+            change = case[metric] / old[metric] - 1
+            worse = -change if higher_is_better else change
+            mark = ''
+            if worse > args.tolerance:
+                mark = ' REGRESSION'
+                regressions += 1
+            changes.append('%s %+.1f%%%s' % (metric, 100 * change, mark))
+        print('%-40s %s' % (case['key'], ', '.join(changes)))
+
+    return regressions
+
+######################################################################
+######################################################################
+######################################################################
+
+results = {
+    'date': datetime.datetime.now().isoformat(timespec='seconds'),
+    'revision': git_revision(),
+    'host': platform.node(),
+    'cases': [],
+}
+
+print('%-40s %10s %10s %14s %12s %10s' % ('case', 'setup (s)', 'run (s)', 'events/s',
+                                         'sim s/s', 'RSS (MB)'))
+for scenario, params in select_cases():
+    try:
+        profiles = [run_case(scenario, params) for _ in range(args.repeat)]
+    except (OSError, RuntimeError) as error:
+        print('ERROR: %s' % error)
+        sys.exit(1)
+
+    profile = min(profiles, key=lambda p: p['run_seconds'])
+    profile.update({'key': case_key(scenario, params), 'scenario': scenario, 'params': params})
+    results['cases'].append(profile)
+    print('%-40s %10.2f %10.2f %14.0f %12.2f %10.1f'
+          % (profile['key'], profile['setup_seconds'], profile['run_seconds'],
+             profile['events_per_second'], profile['simulated_per_wall_second'],
+             profile['peak_rss_kb'] / 1024), flush=True)
+
+os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+with open(args.output, 'w') as out:
+    json.dump(results, out, indent=2)
+
+if args.save_baseline:
+    with open(args.baseline, 'w') as out:
+        json.dump(results, out, indent=2)
+    print('Baseline saved to %s' % args.baseline)
+    sys.exit(0)
+
+if not os.path.exists(args.baseline):
+    print('No baseline to compare with. Create it with --save-baseline.')
+    sys.exit(0)
+
+with open(args.baseline) as f:
+    regressions = compare(results, json.load(f))
+if regressions:
+    print('%d regressions over %.0f%%' % (regressions, 100 * args.tolerance))
+sys.exit(1 if regressions else 0)
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Per-packet cost of the CoDel marking step of ConsumerSrc::CongestionDetected,
+ * with the control law computed on the fly (sqrt and conversions to double
+ * seconds plus a new bernoulli_distribution on the shared engine per packet)
+ * and with the precomputed table and the consumer's own generator. */
+
+#include <ns3/core-module.h>
+
+#include "codel-schedule.hpp"
+#include "fast-random.hpp"
+
+#include <ndn-cxx/util/random.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace ns3 {
+using ::ndn::random::getRandomNumberEngine;
+
+namespace {
+template <typename F>
+auto
+measure(const char* name, uint64_t iterations, F step) -> double
+{
+  Time next = Seconds(0);
+  uint64_t marks = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    marks += step(next, static_cast<uint8_t>(i), 0.25);
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double nsPerPacket =
+    std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+  std::cout << name << '\t' << nsPerPacket << " ns/packet\t(marks: " << marks
+            << ", last mark: " << next.GetSeconds() << "s)" << std::endl;
+
+  return nsPerPacket;
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  uint64_t iterations = 10000000;
+
+  CommandLine cmd;
+  cmd.Usage("Micro-benchmark of the CoDel control law used by ConsumerSrc.\n"
+            "\n");
+  cmd.AddValue("iterations", "Number of simulated marking decisions", iterations);
+  cmd.Parse(argc, argv);
+
+  const Time interval = MilliSeconds(100);
+
+  const double before =
+    measure("sqrt", iterations, [interval](Time& next, uint8_t count, double guilt) {
+      const Time currentInterval = Seconds(interval.GetSeconds() / sqrt(count + 1));
+      next += currentInterval;
+
+      std::bernoulli_distribution congested(guilt);
+      return congested(getRandomNumberEngine());
+    });
+
+  ndn::FastRandom random;
+  const double after =
+    measure("table", iterations, [&random](Time& next, uint8_t count, double guilt) {
+      next += NanoSeconds(ndn::codel::CONTROL_LAW[count]);
+
+      return random.Bernoulli(ndn::FastRandom::Threshold(guilt));
+    });
+
+  std::cout << "Speedup: " << before / after << std::endl;
+
+  // Both versions must agree on the schedule (up to the rounding of Seconds())
+  for (uint16_t count = 0; count < 256; count++) {
+    const Time legacy = Seconds(interval.GetSeconds() / sqrt(count + 1));
+    const Time table = NanoSeconds(ndn::codel::CONTROL_LAW[count]);
+    NS_ABORT_MSG_IF(legacy - table > NanoSeconds(1) || table - legacy > NanoSeconds(1),
+                    "Interval mismatch for count " << count << ": " << legacy << " vs " << table);
+  }
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Checks the congestion mark codec of congestion-mark.hpp against the
+ * encoder that GenericLinkService and the decoder that ConsumerSrc had
+ * written by hand, on random marks, and compares the cost of decoding them
+ * one at a time and with DecodeBatch.
+ *
+ * Rate marks must be identical, except for the rates that are exact powers of
+ * two from 2^15 on, which the old encoder could not represent. Old marks,
+ * rates and delays, must still decode to the same values. Delays have been
+ * encoded in another format since the marks got kinds, so new delay marks
+ * are only checked to keep 15 significant bits. */
+
+#include <ns3/core-module.h>
+
+#include "congestion-mark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+/// Rate mark as encoded by GenericLinkService before the codec. The hop count is set apart.
+auto
+legacyEncodeRate(uint32_t linkId, uint64_t rate) -> uint64_t
+{
+  uint64_t newMark = static_cast<uint64_t>(linkId) << 32;
+  const uint64_t m_lastUpdatedRate = rate;
+
+  const uint8_t exp = std::max(0., ceil(log2(m_lastUpdatedRate) - 15));
+  const uint16_t characteristic = static_cast<uint64_t>(m_lastUpdatedRate) >> exp;
+  newMark |= exp;
+  newMark |= characteristic << 8;
+  newMark |= 0x800000; // Bit 24 is 1
+
+  return newMark;
+}
+
+/// Delay mark as encoded by GenericLinkService before the codec, from a delay in µs
+auto
+legacyEncodeDelay(uint32_t linkId, int64_t delay) -> uint64_t
+{
+  uint64_t newMark = static_cast<uint64_t>(linkId) << 32;
+
+  delay = std::min(delay, (1L << 23) - 1);
+  newMark |= delay;
+
+  return newMark;
+}
+
+/// Hop count update of GenericLinkService before the codec
+auto
+legacySetCount(uint64_t newMark, uint8_t currentCount) -> uint64_t
+{
+  newMark &= 0xFFFFFFFF00FFFFFF; // Remove counter
+  newMark |= static_cast<uint64_t>(currentCount) << 24;
+
+  return newMark;
+}
+
+/// What ConsumerSrc read from a mark before the codec
+struct LegacyDecoded {
+  uint32_t routerId;
+  bool isRate;
+  double rate;      ///< bytes/s
+  uint64_t delayUs; ///< µs
+};
+
+auto
+legacyDecode(uint64_t mark) -> LegacyDecoded
+{
+  LegacyDecoded decoded{};
+  const uint32_t routerId = (mark >> 32U);
+  decoded.routerId = routerId;
+
+  if ((mark & 0x800000U) == 0x800000U) { // A rate
+    const uint8_t exponent = mark & 0xFFU;
+    const uint64_t characteristic = (mark & 0x7FFF00U) >> 8;
+    const double rate = characteristic << exponent;
+
+    decoded.isRate = true;
+    decoded.rate = rate;
+  }
+  else {
+    decoded.delayUs = mark & 0x7FFFFFU;
+  }
+
+  return decoded;
+}
+
+/// Random value whose bit length is uniformly distributed
+auto
+randomValue(std::mt19937_64& random, unsigned maxBits) -> uint64_t
+{
+  const unsigned bits = random() % (maxBits + 1);
+  return bits == 0 ? 0 : random() >> (64 - bits);
+}
+
+auto
+isPowerOfTwo(uint64_t value) -> bool
+{
+  return value != 0 && (value & (value - 1)) == 0;
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  uint64_t marks = 20000000;
+  uint32_t seed = 1;
+
+  CommandLine cmd;
+  cmd.Usage("Checks the congestion mark codec against the previous hand-written one and\n"
+            "measures the cost of decoding marks.\n"
+            "\n");
+  cmd.AddValue("marks", "Number of random marks of each kind", marks);
+  cmd.AddValue("seed", "Seed of the random marks", seed);
+  cmd.Parse(argc, argv);
+
+  std::mt19937_64 random(seed);
+  std::vector<uint64_t> legacyMarks;
+  legacyMarks.reserve(2 * marks);
+  uint64_t overflows = 0;
+
+  for (uint64_t i = 0; i < marks; i++) {
+    const uint32_t linkId = random();
+    const uint8_t count = random();
+
+    // Some rates are powers of two. Rates up to 2^53 bytes/s are exact in a double.
+    const uint64_t rate =
+      random() % 16 == 0 ? uint64_t{1} << (random() % 54) : randomValue(random, 53);
+    const uint64_t rateMark = ndn::mark::SetCount(ndn::mark::EncodeRate(linkId, rate), count);
+    const uint64_t legacyRateMark = legacySetCount(legacyEncodeRate(linkId, rate), count);
+    if (rate >= 1U << 15U && isPowerOfTwo(rate)) {
+      // The mantissa overflowed into the rate flag, so the rate read as 0
+      NS_ABORT_MSG_IF(legacyDecode(legacyRateMark).rate != 0,
+                      "Unexpected legacy encoding of rate " << rate);
+      overflows++;
+    }
+    else {
+      NS_ABORT_MSG_IF(rateMark != legacyRateMark, "Rate " << rate << " encoded as " << std::hex
+                                                          << rateMark << " instead of "
+                                                          << legacyRateMark);
+    }
+    legacyMarks.push_back(legacyRateMark);
+
+    const uint64_t delayUs = randomValue(random, 24);
+    legacyMarks.push_back(legacySetCount(legacyEncodeDelay(linkId, delayUs), count));
+
+    // Floating point delays keep 15 significant bits
+    const uint64_t delayNs = randomValue(random, 64);
+    const uint64_t delayMark = ndn::mark::EncodeDelay(linkId, delayNs);
+    const uint64_t decodedNs = ndn::mark::GetDelayNs(delayMark);
+    NS_ABORT_MSG_IF(ndn::mark::GetKind(delayMark) != ndn::mark::DELAY
+                      || ndn::mark::GetLinkId(delayMark) != linkId || decodedNs > delayNs
+                      || delayNs - decodedNs >= uint64_t{1} << ndn::mark::FloatExponent(delayNs),
+                    "Delay " << delayNs << " ns decoded as " << decodedNs << " ns");
+  }
+
+  // Old marks decoded one at a time and in batches
+  const size_t n = legacyMarks.size();
+  std::vector<LegacyDecoded> legacy(n);
+  std::vector<uint32_t> linkIds(n);
+  std::vector<uint8_t> counts(n);
+  std::vector<uint8_t> kinds(n);
+  std::vector<uint64_t> values(n);
+
+  const auto legacyStart = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; i++) {
+    legacy[i] = legacyDecode(legacyMarks[i]);
+  }
+  const auto batchStart = std::chrono::steady_clock::now();
+  ndn::mark::DecodeBatch(legacyMarks.data(), n, linkIds.data(), counts.data(), kinds.data(),
+                         values.data());
+  const auto end = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t mark = legacyMarks[i];
+    const LegacyDecoded& old = legacy[i];
+    const bool isRate = kinds[i] == ndn::mark::RATE;
+    NS_ABORT_MSG_IF(linkIds[i] != old.routerId || ndn::mark::GetLinkId(mark) != old.routerId
+                      || counts[i] != ndn::mark::GetCount(mark)
+                      || isRate != old.isRate || ndn::mark::IsRate(mark) != old.isRate,
+                    "Mark " << std::hex << mark << " decoded with another kind or origin");
+    if (old.isRate) {
+      NS_ABORT_MSG_IF(values[i] != old.rate || ndn::mark::GetRate(mark) != old.rate,
+                      "Rate mark " << std::hex << mark << " decoded as " << std::dec
+                                   << values[i] << " instead of " << old.rate);
+    }
+    else {
+      NS_ABORT_MSG_IF(values[i] != old.delayUs * 1000
+                        || ndn::mark::GetDelayNs(mark) != old.delayUs * 1000,
+                      "Delay mark " << std::hex << mark << " decoded as " << std::dec
+                                    << values[i] << " ns instead of " << old.delayUs << " µs");
+    }
+  }
+
+  const double legacyNs =
+    std::chrono::duration<double, std::nano>(batchStart - legacyStart).count() / n;
+  const double batchNs = std::chrono::duration<double, std::nano>(end - batchStart).count() / n;
+  std::cout << "legacy\t" << legacyNs << " ns/mark" << std::endl;
+  std::cout << "DecodeBatch\t" << batchNs << " ns/mark\t(speedup: " << legacyNs / batchNs << ")"
+            << std::endl;
+  std::cout << marks << " rates, " << marks << " old delays and " << marks
+            << " new delays agree (" << overflows << " rates were powers of two the old encoder "
+            << "could not represent)" << std::endl;
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Cost of the event schedulers with the classic hold model: the next event is
+ * removed and a new one is inserted some time after it, so the number of
+ * pending events stays the same. The delays mix those of the scenarios: most
+ * are transmission and propagation times, some are Interest timeouts and a
+ * few are far in the future. Some events are cancelled (removed) right after
+ * being scheduled. Every scheduler must run the events in the same order as
+ * the default one. */
+
+#include <ns3/core-module.h>
+
+#include "ladder-scheduler.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+class Hold {
+public:
+  explicit Hold(Ptr<Scheduler> scheduler)
+    : m_scheduler(scheduler)
+    , m_random(1)
+    , m_uid(0)
+  {
+  }
+
+  void
+  Fill(uint32_t pending)
+  {
+    for (uint32_t i = 0; i < pending; i++) {
+      Insert(0);
+    }
+  }
+
+  /// Returns a hash of the order in which the events ran
+  auto
+  Run(uint64_t steps) -> uint64_t
+  {
+    uint64_t order = 0xCBF29CE484222325ULL;
+    for (uint64_t i = 0; i < steps; i++) {
+      const Scheduler::Event next = m_scheduler->RemoveNext();
+      order = (order ^ next.key.m_uid) * 0x100000001B3ULL;
+
+      Insert(next.key.m_ts);
+      if (m_random() % 8 == 0) {
+        m_scheduler->Remove(Insert(next.key.m_ts));
+      }
+    }
+
+    return order;
+  }
+
+private:
+  auto
+  Insert(uint64_t now) -> Scheduler::Event
+  {
+    uint64_t delay;
+    const uint32_t kind = m_random() % 100;
+    if (kind < 70) {
+      delay = m_random() % 100000; // Up to 100 µs: transmissions
+    }
+    else if (kind < 95) {
+      delay = m_random() % 50000000; // Up to 50 ms: propagation, pacing, RTTs
+    }
+    else {
+      delay = m_random() % 4000000000ULL; // Up to 4 s: timeouts
+    }
+
+    Scheduler::Event ev;
+    ev.impl = nullptr;
+    ev.key.m_ts = now + delay;
+    ev.key.m_uid = m_uid++;
+    ev.key.m_context = 0;
+    m_scheduler->Insert(ev);
+
+    return ev;
+  }
+
+  Ptr<Scheduler> m_scheduler;
+  std::mt19937_64 m_random;
+  uint32_t m_uid;
+};
+
+auto
+split(const std::string& list) -> std::vector<std::string>
+{
+  std::vector<std::string> items;
+  std::istringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    items.push_back(item);
+  }
+
+  return items;
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  uint64_t steps = 5000000;
+  std::string pendingList = "1000,100000,1000000";
+  std::string schedulers = "ns3::MapScheduler,ns3::HeapScheduler,ns3::CalendarScheduler,"
+                           "ns3::ndn::LadderScheduler";
+
+  CommandLine cmd;
+  cmd.Usage("Micro-benchmark of the event schedulers with the hold model.\n"
+            "\n");
+  cmd.AddValue("steps", "Events run with each scheduler", steps);
+  cmd.AddValue("pending", "Comma separated numbers of pending events", pendingList);
+  cmd.AddValue("schedulers", "Comma separated TypeIds of the schedulers. The first one is the "
+                             "reference for the order of the events",
+               schedulers);
+  cmd.Parse(argc, argv);
+
+  for (const std::string& pending : split(pendingList)) {
+    uint64_t reference = 0;
+    double referenceNs = 0;
+
+    for (const std::string& scheduler : split(schedulers)) {
+      ObjectFactory factory;
+      factory.SetTypeId(scheduler);
+      Hold hold(factory.Create<Scheduler>());
+      hold.Fill(std::stoul(pending));
+
+      const auto start = std::chrono::steady_clock::now();
+      const uint64_t order = hold.Run(steps);
+      const auto end = std::chrono::steady_clock::now();
+
+      const double nsPerEvent =
+        std::chrono::duration<double, std::nano>(end - start).count() / steps;
+      if (referenceNs == 0) {
+        reference = order;
+        referenceNs = nsPerEvent;
+      }
+      std::cout << pending << " pending\t" << scheduler << '\t' << nsPerEvent << " ns/event\t"
+                << "(speedup: " << referenceNs / nsPerEvent << ")" << std::endl;
+
+      NS_ABORT_MSG_IF(order != reference, scheduler << " ran the events in another order");
+    }
+  }
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
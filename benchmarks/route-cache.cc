@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Checks that the routes installed from the route cache are those that
+ * GlobalRoutingHelper calculates, and compares the cost of both. As the jobs
+ * of a sweep, every case builds the topology from scratch in its own process,
+ * with every node as the origin of its own prefix: GlobalRoutingHelper
+ * calculates the routes, RouteCache calculates and saves them (a miss) and
+ * RouteCache installs them from the file (a hit). Once the forwarders have
+ * processed all the routes, the three FIBs must be identical. */
+
+#include <ns3/core-module.h>
+#include <ns3/ndnSIM-module.h>
+#include <ns3/network-module.h>
+
+#include <ns3/ndnSIM/NFD/daemon/fw/forwarder.hpp>
+
+#include "route-cache.hpp"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+/// The FIB of every node, without the /localhost routes. Each line is an entry with its next hops.
+auto
+dumpFibs() -> std::string
+{
+  std::vector<std::string> lines;
+  const ndn::Name localhost("/localhost");
+
+  for (uint32_t id = 0; id < NodeList::GetNNodes(); id++) {
+    Ptr<ndn::L3Protocol> l3 = NodeList::GetNode(id)->GetObject<ndn::L3Protocol>();
+    for (const nfd::fib::Entry& entry : l3->getForwarder()->getFib()) {
+      if (localhost.isPrefixOf(entry.getPrefix())) {
+        continue;
+      }
+
+      std::ostringstream line;
+      line << id << ' ' << entry.getPrefix();
+      // In the order the forwarder keeps them, which decides among equal costs
+      for (const nfd::fib::NextHop& nextHop : entry.getNextHops()) {
+        line << ' ' << nextHop.getFace().getId() << ':' << nextHop.getCost();
+      }
+      lines.push_back(line.str());
+    }
+  }
+
+  // The iteration order of the FIBs changes from run to run
+  std::sort(lines.begin(), lines.end());
+  std::string fibs;
+  for (const std::string& line : lines) {
+    fibs += line + '\n';
+  }
+
+  return fibs;
+}
+
+/// Builds the topology, installs its routes and writes the FIBs to output. Runs in a child.
+void
+route(const std::string& name, const std::string& topologyFile, const std::string& cache,
+      const std::string& output)
+{
+  AnnotatedTopologyReader topologyReader("", 25);
+  topologyReader.SetFileName(topologyFile);
+  topologyReader.Read();
+
+  ndn::StackHelper ndnHelper;
+  ndnHelper.InstallAll();
+  ndn::StrategyChoiceHelper::InstallAll("/", "/localhost/nfd/strategy/best-route");
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll();
+
+  ndn::RouteCache routes(topologyFile, cache);
+  for (uint32_t id = 0; id < NodeList::GetNNodes(); id++) {
+    Ptr<Node> node = NodeList::GetNode(id);
+    routes.AddOrigins("/origin-" + std::to_string(id), node);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  routes.CalculateRoutes();
+  const auto end = std::chrono::steady_clock::now();
+
+  // Let the forwarders process the routes
+  Simulator::Stop(Seconds(1));
+  Simulator::Run();
+
+  const std::string fibs = dumpFibs();
+  std::ofstream(output) << fibs;
+  std::cout << name << '\t' << std::chrono::duration<double, std::milli>(end - start).count()
+            << " ms\t(" << std::count(fibs.begin(), fibs.end(), '\n') << " FIB entries)"
+            << std::endl;
+
+  Simulator::Destroy();
+}
+
+/// Runs route() in a new process, so that every case starts from an empty simulation
+void
+runCase(const std::string& name, const std::string& topologyFile, const std::string& cache,
+     const std::string& output)
+{
+  std::cout.flush();
+  const pid_t pid = ::fork();
+  NS_ABORT_MSG_IF(pid < 0, "Cannot fork " << name);
+  if (pid == 0) {
+    route(name, topologyFile, cache, output);
+    std::exit(0);
+  }
+
+  int status;
+  NS_ABORT_MSG_IF(waitpid(pid, &status, 0) != pid || !WIFEXITED(status)
+                    || WEXITSTATUS(status) != 0,
+                  name << " failed");
+}
+
+auto
+readFile(const std::string& fileName) -> std::string
+{
+  std::ifstream file(fileName);
+  std::ostringstream content;
+  content << file.rdbuf();
+
+  return content.str();
+}
+
+/// Inode of the only route file of the cache, which changes if it is written again
+auto
+cacheFile(const std::string& directory) -> ino_t
+{
+  DIR* dir = opendir(directory.c_str());
+  NS_ABORT_MSG_IF(dir == nullptr, "The routes were not saved in " << directory);
+
+  std::vector<std::string> files;
+  while (const struct dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".fib") == 0) {
+      files.push_back(directory + '/' + name);
+    }
+  }
+  closedir(dir);
+  NS_ABORT_MSG_IF(files.size() != 1, files.size() << " route files in " << directory);
+
+  struct stat status;
+  NS_ABORT_MSG_IF(stat(files.front().c_str(), &status) != 0, "Cannot read " << files.front());
+
+  return status.st_ino;
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  std::string topologyFile = "scenarios/scenario-parking-lot.txt";
+
+  CommandLine cmd;
+  cmd.Usage("Checks that the routes installed from the route cache are the same that\n"
+            "GlobalRoutingHelper calculates, and measures the cost of both.\n"
+            "\n");
+  cmd.AddValue("topoFile", "Topology file", topologyFile);
+  cmd.Parse(argc, argv);
+
+  char scratch[] = "/tmp/route-cache-XXXXXX";
+  NS_ABORT_MSG_IF(mkdtemp(scratch) == nullptr, "Cannot create a scratch directory");
+  const std::string directory = scratch;
+  const std::string cache = directory + "/cache";
+
+  runCase("calculated", topologyFile, "", directory + "/calculated.fib");
+  runCase("miss", topologyFile, cache, directory + "/miss.fib");
+  const ino_t saved = cacheFile(cache);
+  runCase("hit", topologyFile, cache, directory + "/hit.fib");
+
+  const std::string calculated = readFile(directory + "/calculated.fib");
+  NS_ABORT_MSG_IF(cacheFile(cache) != saved, "The cached routes were calculated again");
+  NS_ABORT_MSG_IF(readFile(directory + "/miss.fib") != calculated,
+                  "The routes calculated by the cache differ, see " << directory);
+  NS_ABORT_MSG_IF(readFile(directory + "/hit.fib") != calculated,
+                  "The routes loaded from the cache differ, see " << directory);
+
+  std::cout << "The FIBs are identical" << std::endl;
+  NS_ABORT_MSG_IF(std::system(("rm -r " + directory).c_str()) != 0,
+                  "Cannot remove " << directory);
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
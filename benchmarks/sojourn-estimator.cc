@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Per-packet cost of measuring the time packets spend in the device queue of
+ * the patched GenericLinkService, with DelayJitterEstimation (a byte tag added
+ * on enqueue and looked up on dequeue) and with the SojournEstimator ring.
+ * Both estimators are then fed the same simulated queue and must report the
+ * same delays. */
+
+#include <ns3/core-module.h>
+#include <ns3/delay-jitter-estimation.h>
+#include <ns3/packet.h>
+
+#include "sojourn-estimator.hpp"
+
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <random>
+
+namespace ns3 {
+
+namespace {
+/// Keeps queueLength packets queued: each step enqueues a new packet and dequeues the oldest
+template <typename Enqueue, typename Dequeue>
+auto
+measure(const char* name, uint64_t iterations, uint32_t queueLength, Enqueue enqueue,
+        Dequeue dequeue) -> double
+{
+  std::deque<Ptr<Packet>> queue;
+  for (uint32_t i = 0; i < queueLength; i++) {
+    queue.push_back(Create<Packet>(1000));
+    enqueue(queue.back());
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < iterations; i++) {
+    queue.push_back(Create<Packet>(1000));
+    enqueue(queue.back());
+    dequeue(queue.front());
+    queue.pop_front();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double nsPerPacket =
+    std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+  std::cout << name << '\t' << nsPerPacket << " ns/packet" << std::endl;
+
+  return nsPerPacket;
+}
+
+/// Random arrivals and departures to a queue traced by both estimators
+class Comparison {
+public:
+  explicit Comparison(uint64_t steps)
+    : m_steps(steps)
+    , m_random(1)
+  {
+  }
+
+  void
+  Step()
+  {
+    if (m_steps-- == 0) {
+      return;
+    }
+
+    // Slightly more arrivals than departures, so that the queue builds up
+    if (m_queue.empty() || m_random() % 100 < 51) {
+      m_queue.push_back(Create<Packet>(1000));
+      m_legacy.PrepareTx(m_queue.back());
+      m_ring.OnEnqueue();
+    }
+    else {
+      m_legacy.RecordRx(m_queue.front());
+      m_ring.OnDequeue();
+      m_queue.pop_front();
+
+      NS_ABORT_MSG_IF(m_legacy.GetLastDelay() != m_ring.GetLastDelay(),
+                      "Delay mismatch at " << Simulator::Now() << ": "
+                                           << m_legacy.GetLastDelay() << " vs "
+                                           << m_ring.GetLastDelay());
+    }
+
+    Simulator::Schedule(NanoSeconds(m_random() % 20000), &Comparison::Step, this);
+  }
+
+  auto
+  GetSamples() const -> uint64_t
+  {
+    return m_ring.GetSamples();
+  }
+
+private:
+  uint64_t m_steps;
+  std::mt19937 m_random;
+  std::deque<Ptr<Packet>> m_queue;
+  DelayJitterEstimation m_legacy;
+  ndn::SojournEstimator m_ring;
+};
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  uint64_t iterations = 10000000;
+  uint32_t queueLength = 100;
+
+  CommandLine cmd;
+  cmd.Usage("Micro-benchmark of the queueing delay estimation of the patched link service.\n"
+            "\n");
+  cmd.AddValue("iterations", "Number of packets that go through the queue", iterations);
+  cmd.AddValue("queueLength", "Packets kept in the queue", queueLength);
+  cmd.Parse(argc, argv);
+
+  DelayJitterEstimation legacy;
+  const double before = measure(
+    "tag", iterations, queueLength, [&legacy](Ptr<Packet> p) { legacy.PrepareTx(p); },
+    [&legacy](Ptr<Packet> p) { legacy.RecordRx(p); });
+
+  ndn::SojournEstimator ring;
+  const double after = measure(
+    "ring", iterations, queueLength, [&ring](Ptr<Packet>) { ring.OnEnqueue(); },
+    [&ring](Ptr<Packet>) { ring.OnDequeue(); });
+
+  std::cout << "Speedup: " << before / after
+            << " (includes the cost of creating the packets in both cases)" << std::endl;
+
+  Comparison comparison(1000000);
+  Simulator::ScheduleNow(&Comparison::Step, &comparison);
+  Simulator::Run();
+  Simulator::Destroy();
+  std::cout << "Both estimators agree on " << comparison.GetSamples() << " delays" << std::endl;
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CODEL_SCHEDULE_H
+#define NDN_CODEL_SCHEDULE_H
+
+#include <cstdint>
+
+namespace ns3 {
+namespace ndn {
+namespace codel {
+
+/// CoDel interval, in nanoseconds
+constexpr int64_t INTERVAL_NS = 100000000;
+
+/// Integer square root (rounded down)
+constexpr auto
+ISqrt(uint64_t value) -> uint64_t
+{
+  if (value < 2) {
+    return value;
+  }
+
+  uint64_t x = value;
+  uint64_t y = (x + 1) / 2;
+  while (y < x) {
+    x = y;
+    y = (x + value / x) / 2;
+  }
+
+  return x;
+}
+
+/**
+ * CoDel control law: time between marks after count marks, i.e.,
+ * interval / sqrt(count + 1). As the count is kept in a uint8_t, every
+ * possible value is computed at compile time.
+ */
+class ControlLaw {
+public:
+  constexpr ControlLaw()
+    : m_intervals{}
+  {
+    for (uint64_t count = 0; count < 256; count++) {
+      // interval / sqrt(n) == sqrt(interval² / n)
+      m_intervals[count] = ISqrt(INTERVAL_NS * INTERVAL_NS / (count + 1));
+    }
+  }
+
+  /// Next interval, in nanoseconds
+  constexpr auto
+  operator[](uint8_t count) const -> int64_t
+  {
+    return m_intervals[count];
+  }
+
+private:
+  int64_t m_intervals[256];
+};
+
+constexpr ControlLaw CONTROL_LAW{};
+
+static_assert(CONTROL_LAW[0] == INTERVAL_NS, "The first interval must be the CoDel interval");
+static_assert(CONTROL_LAW[3] == INTERVAL_NS / 2, "interval / sqrt(4) must be interval / 2");
+
+} // namespace codel
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CODEL_SCHEDULE_H
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_CONGESTION_MARK_H
+#define NDN_CONGESTION_MARK_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Congestion mark carried in the NDNLP CongestionMark field. It is written by
+ * the patched GenericLinkService (see extras/) and read by ConsumerSrc, so this
+ * header must not depend on ns-3.
+ *
+ *   63          32 31      24  23  22                8 7    6 5        0
+ *  +--------------+----------+---+-------------------+------+----------+
+ *  |   link ID    | hops     | 1 | mantissa          | kind | exponent |  value = mantissa << exponent
+ *  +--------------+----------+---+-------------------+------+----------+
+ *  |   link ID    | hops     | 0 | queueing delay (µs)                 |  version 0 delay
+ *  +--------------+----------+---+-------------------------------------+
+ *
+ * The kind of the first format tells what the value is: 0 is a rate in bytes
+ * per second and 1 a queueing delay in nanoseconds. Kinds 2 and 3 are reserved
+ * for future marks and must be ignored.
+ *
+ * Version 0 marks are still decoded. Their rate marks had an 8 bit exponent
+ * that never reached 64, so they read as kind 0 marks with the same value.
+ * Their delay marks, with 1 µs resolution and saturated at 8.4 s, are no
+ * longer generated, as the floating point delays resolve the sub-microsecond
+ * queues of 10-100 Gbps links and have no practical upper limit.
+ */
+
+namespace ns3 {
+namespace ndn {
+namespace mark {
+
+constexpr uint64_t FLOAT_FLAG = 0x800000;
+constexpr uint64_t COUNT_MASK = 0xFF000000;
+constexpr uint64_t MANTISSA_MASK = 0x7FFF00;
+constexpr uint64_t KIND_MASK = 0xC0;
+constexpr uint64_t EXPONENT_MASK = 0x3F;
+constexpr uint64_t LEGACY_DELAY_MASK = 0x7FFFFF;
+constexpr unsigned MANTISSA_BITS = 15;
+
+/// What a mark carries
+enum Kind : uint8_t {
+  RATE = 0,    ///< Rate, in bytes per second
+  DELAY = 1,   ///< Queueing delay, in nanoseconds
+  UNKNOWN = 2, ///< Reserved for future marks. Nothing can be learnt from them.
+};
+
+constexpr auto
+GetLinkId(uint64_t mark) noexcept -> uint32_t
+{
+  return mark >> 32U;
+}
+
+/// Number of routers that have seen the mark
+constexpr auto
+GetCount(uint64_t mark) noexcept -> uint8_t
+{
+  return (mark & COUNT_MASK) >> 24U;
+}
+
+constexpr auto
+GetKind(uint64_t mark) noexcept -> Kind
+{
+  return (mark & FLOAT_FLAG) == 0              ? DELAY
+         : (mark & KIND_MASK) >> 6U < UNKNOWN ? static_cast<Kind>((mark & KIND_MASK) >> 6U)
+                                               : UNKNOWN;
+}
+
+constexpr auto
+IsRate(uint64_t mark) noexcept -> bool
+{
+  return GetKind(mark) == RATE;
+}
+
+/// Value of the floating point format
+constexpr auto
+GetValue(uint64_t mark) noexcept -> uint64_t
+{
+  return ((mark & MANTISSA_MASK) >> 8U) << (mark & EXPONENT_MASK);
+}
+
+/// Rate, in bytes per second. Only valid if GetKind() is RATE
+constexpr auto
+GetRate(uint64_t mark) noexcept -> uint64_t
+{
+  return GetValue(mark);
+}
+
+/// Queueing delay, in nanoseconds. Only valid if GetKind() is DELAY
+constexpr auto
+GetDelayNs(uint64_t mark) noexcept -> uint64_t
+{
+  return (mark & FLOAT_FLAG) != 0 ? GetValue(mark) : (mark & LEGACY_DELAY_MASK) * 1000;
+}
+
+/// Number of significant bits of value
+constexpr auto
+BitLength(uint64_t value) noexcept -> unsigned
+{
+  unsigned bits = 0;
+  while (value != 0) {
+    value >>= 1U;
+    bits++;
+  }
+
+  return bits;
+}
+
+/// Smallest exponent that makes the mantissa fit in MANTISSA_BITS
+constexpr auto
+FloatExponent(uint64_t value) noexcept -> uint8_t
+{
+  return BitLength(value) > MANTISSA_BITS ? BitLength(value) - MANTISSA_BITS : 0;
+}
+
+/// Floating point mark with a zero hop count. The value is rounded down to the mantissa precision.
+constexpr auto
+EncodeFloat(uint32_t linkId, Kind kind, uint64_t value) noexcept -> uint64_t
+{
+  return static_cast<uint64_t>(linkId) << 32U | FLOAT_FLAG | (value >> FloatExponent(value)) << 8U
+         | static_cast<uint64_t>(kind) << 6U | FloatExponent(value);
+}
+
+/**
+ * Rate mark with a zero hop count. The rate is rounded down to the mantissa precision.
+ *
+ * The original hand-written encoder overflowed the mantissa into the rate flag
+ * for rates that are exact powers of two from 2^15 on. These now get one more
+ * exponent bit instead; every other rate is encoded identically.
+ */
+constexpr auto
+EncodeRate(uint32_t linkId, uint64_t rate) noexcept -> uint64_t
+{
+  return EncodeFloat(linkId, RATE, rate);
+}
+
+/// Delay mark with a zero hop count. The delay, in nanoseconds, keeps 15 significant bits.
+constexpr auto
+EncodeDelay(uint32_t linkId, uint64_t delayNs) noexcept -> uint64_t
+{
+  return EncodeFloat(linkId, DELAY, delayNs);
+}
+
+constexpr auto
+SetCount(uint64_t mark, uint8_t count) noexcept -> uint64_t
+{
+  return (mark & ~COUNT_MASK) | static_cast<uint64_t>(count) << 24U;
+}
+
+/**
+ * Decodes a batch of marks (e.g. from a recorded trace) into separate arrays.
+ *
+ * \p values receives the rate (bytes/s) of rate marks and the delay (ns) of
+ * delay marks, and \p kinds tells them apart. The loop is branch free so that
+ * compilers can vectorize it.
+ */
+inline void
+DecodeBatch(const uint64_t* marks, size_t n, uint32_t* linkIds, uint8_t* counts, uint8_t* kinds,
+            uint64_t* values) noexcept
+{
+  for (size_t i = 0; i < n; i++) {
+    const uint64_t mark = marks[i];
+    const uint64_t isFloat = (mark & FLOAT_FLAG) >> 23U;
+    const uint64_t kind = (mark & KIND_MASK) >> 6U;
+
+    linkIds[i] = mark >> 32U;
+    counts[i] = (mark & COUNT_MASK) >> 24U;
+    kinds[i] = isFloat != 0 ? (kind < UNKNOWN ? kind : uint64_t{UNKNOWN}) : uint64_t{DELAY};
+    values[i] = isFloat != 0 ? ((mark & MANTISSA_MASK) >> 8U) << (mark & EXPONENT_MASK)
+                             : (mark & LEGACY_DELAY_MASK) * 1000;
+  }
+}
+
+static_assert(GetRate(EncodeRate(1, 12500000)) == 12500000 >> 9 << 9, "Rate round trip");
+static_assert(GetDelayNs(EncodeDelay(1, 5000)) == 5000, "Delay round trip");
+static_assert(GetDelayNs(EncodeDelay(1, 600000000000)) == 600000000000 >> 25 << 25,
+              "Delays longer than the version 0 limit");
+static_assert(GetKind(EncodeRate(1, 12500000000)) == RATE, "100 Gbps rate kind");
+static_assert(GetKind(EncodeDelay(1, 1)) == DELAY, "Delay kind");
+static_assert(GetKind(0xCAFE008000C0) == UNKNOWN, "Reserved kind");
+static_assert(GetLinkId(SetCount(EncodeRate(0xCAFE, 1000), 3)) == 0xCAFE, "Link ID round trip");
+static_assert(GetCount(SetCount(EncodeDelay(0xCAFE, 1000), 3)) == 3, "Count round trip");
+static_assert(FloatExponent((1U << 15) - 1) == 0 && FloatExponent(1U << 15) == 1, "Exponent");
+
+// Version 0 marks
+static_assert(GetKind(0xCAFE03001388) == DELAY && GetDelayNs(0xCAFE03001388) == 5000000,
+              "Version 0 delay of 5 ms");
+static_assert(GetKind(0xCAFE03BD0909) == RATE && GetRate(0xCAFE03BD0909) == 0x3D09ULL << 9,
+              "Version 0 rate");
+
+} // namespace mark
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CONGESTION_MARK_H
@@ -18,8 +18,13 @@
  **/
 
 #include "consumer-src.hpp"
+#include "codel-schedule.hpp"
+#include "congestion-mark.hpp"
 #include "ns3/nstime.h"
-#include <ndn-cxx/util/random.hpp>
+#include <ns3/names.h>
+#include <ns3/rng-seed-manager.h>
+#include <ndn-cxx/lp/tags.hpp>
+#include <cmath>
 #include <utility>
 
 NS_LOG_COMPONENT_DEFINE("ndn.ConsumerSrc");
@@ -28,7 +33,6 @@ namespace ns3
 
 {
 namespace ndn {
-using ::ndn::random::getRandomNumberEngine;
 
 NS_OBJECT_ENSURE_REGISTERED(ConsumerSrc);
 
@@ -40,6 +44,9 @@ ConsumerSrc::GetTypeId() -> TypeId
       .SetGroupName("Ndn")
       .SetParent<ConsumerWindow>()
       .AddConstructor<ConsumerSrc>()
+      .AddAttribute("CcAlgorithm", "Window growth algorithm", EnumValue(AIMD),
+                    MakeEnumAccessor(&ConsumerSrc::m_ccAlgorithm),
+                    MakeEnumChecker(AIMD, "AIMD", CUBIC, "CUBIC"))
       .AddAttribute("Beta", "TCP Multiplicative Decrease factor", DoubleValue(0.5),
                     MakeDoubleAccessor(&ConsumerSrc::m_beta), MakeDoubleChecker<double>())
       .AddAttribute("AddRttSuppress",
@@ -47,8 +54,44 @@ ConsumerSrc::GetTypeId() -> TypeId
                     "decreases",
                     DoubleValue(0.5), // This default value was chosen after manual testing
                     MakeDoubleAccessor(&ConsumerSrc::m_addRttSuppress), MakeDoubleChecker<double>())
-      .AddAttribute("DumpCongestion", "Dump congestion statistics to stdout", BooleanValue(false),
-                    MakeBooleanAccessor(&ConsumerSrc::dumpCongestion), MakeBooleanChecker());
+      .AddAttribute("CubicFastConvergence",
+                    "Release bandwidth faster to new flows when using CUBIC", BooleanValue(true),
+                    MakeBooleanAccessor(&ConsumerSrc::m_cubicFastConvergence),
+                    MakeBooleanChecker())
+      .AddAttribute("Pacing",
+                    "Space Interests according to the window, the RTT and the lowest rate "
+                    "reported along the path instead of sending them in bursts",
+                    BooleanValue(false), MakeBooleanAccessor(&ConsumerSrc::m_pacing),
+                    MakeBooleanChecker())
+      .AddAttribute("ReorderThreshold",
+                    "Sequence distance to the newest Data after which an outstanding "
+                    "Interest is considered lost and retransmitted",
+                    UintegerValue(3), MakeUintegerAccessor(&ConsumerSrc::m_reorderThreshold),
+                    MakeUintegerChecker<uint32_t>(1))
+      .AddAttribute("InFlightTracking",
+                    "Bookkeeping of the Interests in flight: the CONTAINERS of the ndnSIM "
+                    "Consumer, or a RING indexed by sequence number with a single timeout timer, "
+                    "which does not allocate memory per Interest",
+                    EnumValue(CONTAINERS), MakeEnumAccessor(&ConsumerSrc::m_tracking),
+                    MakeEnumChecker(CONTAINERS, "CONTAINERS", RING, "RING"))
+      .AddAttribute("RouterTimeout",
+                    "Time without news from a router after which its state is discarded",
+                    TimeValue(Seconds(5)),
+                    MakeTimeAccessor(&ConsumerSrc::SetRouterTimeout,
+                                     &ConsumerSrc::GetRouterTimeout),
+                    MakeTimeChecker())
+      .AddTraceSource("RouterRate", "Rate (bytes/s) reported by a router in a congestion mark",
+                      MakeTraceSourceAccessor(&ConsumerSrc::m_routerRateTrace),
+                      "ns3::ndn::ConsumerSrc::RouterRateCallback")
+      .AddTraceSource("RouterDelay", "Queueing delay reported by a router in a congestion mark",
+                      MakeTraceSourceAccessor(&ConsumerSrc::m_routerDelayTrace),
+                      "ns3::ndn::ConsumerSrc::RouterDelayCallback")
+      .AddTraceSource("CongestionEvent", "Congestion detected. Reports the reduced window",
+                      MakeTraceSourceAccessor(&ConsumerSrc::m_congestionEventTrace),
+                      "ns3::ndn::ConsumerSrc::CongestionEventCallback")
+      .AddTraceSource("Timeout", "Interest timed out. Reports the window and packets in flight",
+                      MakeTraceSourceAccessor(&ConsumerSrc::m_timeoutTrace),
+                      "ns3::ndn::ConsumerSrc::TimeoutCallback");
 
   return tid;
 }
@@ -57,6 +100,9 @@ ConsumerSrc::ConsumerSrc()
   : m_ssthresh(std::numeric_limits<double>::max())
   , m_highData(0)
   , m_recPoint(0.0)
+  , m_highDataSentTime(Seconds(0))
+  , m_nextSendTime(Seconds(0))
+  , m_tracking(CONTAINERS)
   , m_cubicWmax(0)
   , m_cubicLastWmax(0)
   , m_cubicLastDecrease(ns3::Simulator::Now())
@@ -64,38 +110,163 @@ ConsumerSrc::ConsumerSrc()
 }
 
 void
-ConsumerSrc::OnData(shared_ptr<const Data> data)
+ConsumerSrc::StartApplication()
+{
+  // Named after the node and the prefix, so that the stream does not change
+  // when other nodes or applications are added
+  std::string name = Names::FindName(GetNode());
+  if (name.empty()) {
+    name = std::to_string(GetNode()->GetId());
+  }
+  m_random.Seed(RngSeedManager::GetSeed(), RngSeedManager::GetRun(),
+                FastRandom::StreamId(name + m_interestName.toUri()));
+
+  // The timeouts of the ring are checked by its own timer
+  if (m_tracking == RING) {
+    Simulator::Cancel(m_retxEvent);
+  }
+
+  ConsumerWindow::StartApplication();
+}
+
+void
+ConsumerSrc::StopApplication()
+{
+  Simulator::Cancel(m_timeoutEvent);
+
+  ConsumerWindow::StopApplication();
+}
+
+void
+ConsumerSrc::WillSendOutInterest(uint32_t sequenceNum)
+{
+  if (m_tracking == CONTAINERS) {
+    ConsumerWindow::WillSendOutInterest(sequenceNum);
+    return;
+  }
+
+  m_inFlightWindow.OnSend(sequenceNum, ns3::Simulator::Now());
+  m_inFlight = m_inFlightWindow.GetOutstanding();
+
+  // Checked as often as Consumer::CheckRetxTimeout, but only while there are Interests to check
+  if (!m_timeoutEvent.IsRunning()) {
+    m_timeoutEvent = ns3::Simulator::Schedule(m_retxTimer, &ConsumerSrc::CheckTimeouts, this);
+  }
+}
+
+void
+ConsumerSrc::CheckTimeouts()
+{
+  const Time deadline = ns3::Simulator::Now() - m_rtt->RetransmitTimeout();
+  m_inFlightWindow.Expire(deadline, [this](uint32_t sequenceNum) { OnTimeout(sequenceNum); });
+
+  if (m_inFlightWindow.HasPending()) {
+    m_timeoutEvent = ns3::Simulator::Schedule(m_retxTimer, &ConsumerSrc::CheckTimeouts, this);
+  }
+}
+
+auto
+ConsumerSrc::GetOutstanding() const -> uint32_t
 {
-  ns3::ndn::Consumer::OnData(data);
+  return m_tracking == RING ? m_inFlightWindow.GetOutstanding() : m_seqTimeouts.size();
+}
 
+void
+ConsumerSrc::OnData(shared_ptr<const Data> data)
+{
   uint64_t sequenceNum = data->getName().get(-1).toSequenceNumber();
 
+  if (m_tracking == RING) {
+    App::OnData(data);
+    ReleaseInterest(*data, sequenceNum);
+  }
+  else {
+    // Consumer::OnData forgets when the Interest was sent, so look it up first
+    const auto sent = m_seqTimeouts.find(sequenceNum);
+    if (sent != m_seqTimeouts.end() && sent->time > m_highDataSentTime) {
+      m_highDataSentTime = sent->time;
+    }
+
+    ns3::ndn::Consumer::OnData(data);
+  }
+
   // Set highest received Data to sequence number
   if (m_highData < sequenceNum) {
     m_highData = sequenceNum;
   }
 
-  if (CongestionDetected(*data)) {
-    if (dumpCongestion) {
-      std::cout << ns3::Simulator::Now().GetSeconds() << " Congestion" << std::endl;
-    }
+  // Congestion must always be checked, as it also keeps the state of the routers
+  const bool congested = CongestionDetected(*data);
+  if (DetectLosses() || congested) {
     WindowDecrease();
+    m_congestionEventTrace(m_window);
   }
   else {
     WindowIncrease();
   }
 
-  m_inFlight = m_seqTimeouts.size();
+  m_inFlight = GetOutstanding();
 
   NS_LOG_DEBUG("Window: " << std::dec << m_window << ", InFlight: " << m_inFlight);
 
   ScheduleNextPacket();
 }
 
+void
+ConsumerSrc::ScheduleNextPacket()
+{
+  if (!m_pacing) {
+    ConsumerWindow::ScheduleNextPacket();
+    return;
+  }
+
+  // The window shrank below what is in flight. SendPacket does not check it, so
+  // the Interest waiting for its turn must not be sent; its turn is given back.
+  if (m_inFlight >= m_window) {
+    if (m_sendEvent.IsRunning()) {
+      m_nextSendTime = TimeStep(m_sendEvent.GetTs());
+      ns3::Simulator::Remove(m_sendEvent);
+    }
+    ConsumerWindow::ScheduleNextPacket(); // Probes an empty window
+    return;
+  }
+
+  // The next Interest is already waiting for its turn
+  if (m_sendEvent.IsRunning()) {
+    return;
+  }
+
+  const Time now = ns3::Simulator::Now();
+  const Time sendTime = std::max(now, m_nextSendTime);
+
+  m_nextSendTime = sendTime + PacingInterval();
+  m_sendEvent = ns3::Simulator::Schedule(sendTime - now, &Consumer::SendPacket, this);
+}
+
+/* Interests are sent at the window rate, with some headroom for the window to
+ * grow as in Linux TCP pacing (twice the rate in slow start, 1.2 times
+ * otherwise), but never faster than the slowest router on the path can send
+ * the Data back. */
+auto
+ConsumerSrc::PacingInterval() const -> Time
+{
+  const double gain = m_window < m_ssthresh ? 2.0 : 1.2;
+  double interval = m_rtt->GetCurrentEstimate().GetSeconds() / (gain * m_window.Get());
+
+  if (m_path.minRate > 0) {
+    interval = std::max(interval, m_payloadSize / m_path.minRate);
+  }
+
+  return Seconds(interval);
+}
+
 void
 ConsumerSrc::WindowIncrease() noexcept
 {
-  if (m_window < m_ssthresh) {
+  if (m_ccAlgorithm == CUBIC) {
+    CubicIncrease();
+  }
+  else if (m_window < m_ssthresh) {
     m_window += 1.0;
   }
   else {
@@ -112,100 +283,269 @@ ConsumerSrc::WindowDecrease() noexcept
 
   m_recPoint = m_seq + (m_addRttSuppress * diff);
 
-  m_ssthresh = m_window * m_beta;
-  m_window = m_ssthresh;
+  if (m_ccAlgorithm == CUBIC) {
+    CubicDecrease();
+  }
+  else {
+    m_ssthresh = m_window * m_beta;
+    m_window = m_ssthresh;
+  }
 
   if (m_window < m_initialWindow) {
     m_window = m_initialWindow;
   }
 }
 
+// CUBIC as described in RFC 8312, with windows in packets
 void
-ConsumerSrc::OnTimeout(uint32_t sequenceNum)
+ConsumerSrc::CubicIncrease() noexcept
 {
-  WindowDecrease();
+  if (m_window < m_ssthresh) {
+    m_window += 1.0;
+    return;
+  }
+
+  const double window = m_window;
+  const double rtt = m_rtt->GetCurrentEstimate().GetSeconds();
+  const double t = (ns3::Simulator::Now() - m_cubicLastDecrease).GetSeconds();
 
-  m_inFlight = m_seqTimeouts.size();
+  // Time to get back to W_max: K = cubic_root(W_max * (1 - beta_cubic) / C) (Eq. 2)
+  const double k = std::cbrt(m_cubicWmax * (1 - m_cubicBeta) / CUBIC_C);
 
-  std::cerr << "Timeout Window: " << std::dec << m_window << ", InFlight: " << m_inFlight
-            << std::endl;
+  // Target one RTT ahead: W_cubic(t + RTT) = C * (t + RTT - K)^3 + W_max (Eq. 1)
+  const double wCubic = CUBIC_C * std::pow(t + rtt - k, 3) + m_cubicWmax;
 
-  ns3::ndn::Consumer::OnTimeout(sequenceNum);
+  // Window of a standard TCP flow with the same loss rate (Eq. 4)
+  const double wEst =
+    m_cubicWmax * m_cubicBeta + 3 * (1 - m_cubicBeta) / (1 + m_cubicBeta) * t / rtt;
+
+  if (wCubic < wEst) { // TCP friendly region
+    m_window = std::max(window, wEst);
+  }
+  else if (wCubic > window) { // Concave and convex regions
+    m_window += (wCubic - window) / window;
+  }
+}
+
+void
+ConsumerSrc::CubicDecrease() noexcept
+{
+  const double window = m_window;
+
+  // Fast convergence: a flow that is losing share releases more bandwidth
+  if (m_cubicFastConvergence && window < m_cubicLastWmax) {
+    m_cubicLastWmax = window;
+    m_cubicWmax = window * (1 + m_cubicBeta) / 2;
+  }
+  else {
+    m_cubicLastWmax = window;
+    m_cubicWmax = window;
+  }
+
+  m_ssthresh = window * m_cubicBeta;
+  m_window = m_ssthresh;
+
+  m_cubicLastDecrease = ns3::Simulator::Now();
 }
 
+/* Gap based loss detection. An outstanding Interest is lost when Data for an
+ * Interest ReorderThreshold sequence numbers ahead has arrived, provided it was
+ * sent before that Interest (so retransmissions get a chance to be answered).
+ * Send times are compared, so Interests sent in the same instant as the newest
+ * answered one (a burst scheduled with ScheduleNow) are only found lost once an
+ * Interest sent later is answered, or when they time out. Lost Interests are
+ * retransmitted right away instead of waiting for their timeout. Returns true
+ * if the losses start a new loss episode, i.e., some lost Interest was sent
+ * after the last window reduction. */
 auto
-ConsumerSrc::CongestionDetected(const Data& data) noexcept -> bool
+ConsumerSrc::DetectLosses() -> bool
 {
-  const uint64_t mark = data.getCongestionMark();
-  const uint32_t routerId = (mark >> 32U);
-
-  if ((mark & 0x800000U) == 0x800000U) { // A rate
-    const uint8_t exponent = mark & 0xFFU;
-    const uint64_t characteristic = (mark & 0x7FFF00U) >> 8;
-    const double rate = characteristic << exponent;
-
-    m_routerInfo[routerId].SetRate(rate);
-    if (dumpCongestion) {
-      std::cout << ns3::Simulator::Now().GetSeconds() << " RID: " << routerId << " rate: " << rate
-                << std::endl;
+  if (m_highData < m_reorderThreshold) {
+    return false;
+  }
+
+  const uint32_t lastLost = m_highData - m_reorderThreshold;
+  bool newEpisode = false;
+  auto lose = [this, &newEpisode](uint32_t sequenceNum) {
+    NS_LOG_DEBUG("Lost Interest " << sequenceNum);
+    if (sequenceNum > m_recPoint) {
+      newEpisode = true;
     }
+    m_retxSeqs.insert(sequenceNum);
+  };
+
+  if (m_tracking == RING) {
+    m_inFlightWindow.ExpireUpTo(lastLost, m_highDataSentTime, lose);
+    return newEpisode;
   }
-  else {
-    m_routerInfo[routerId].SetDelay(MicroSeconds(mark & 0x7FFFFFU));
-    if (dumpCongestion) {
-      std::cout << ns3::Simulator::Now().GetSeconds() << " RID: " << routerId
-                << " delay: " << MicroSeconds(mark & 0x7FFFFFU).GetSeconds() << std::endl;
+
+  auto& outstanding = m_seqTimeouts.get<i_seq>();
+  auto entry = outstanding.begin();
+  while (entry != outstanding.end() && entry->seq <= lastLost) {
+    if (entry->time < m_highDataSentTime) {
+      lose(entry->seq);
+      entry = outstanding.erase(entry);
+    }
+    else {
+      ++entry;
     }
   }
 
-  RouterStatus& rInfo = m_routerInfo.at(routerId);
-  const double rate = rInfo.GetRate();
-  const Time delay = rInfo.GetDelay();
-  if (rate == 0) {
+  return newEpisode;
+}
+
+/* What Consumer::OnData does with its containers. The RTT is only sampled if
+ * the Interest was sent once (Karn's rule) and is still outstanding. */
+void
+ConsumerSrc::ReleaseInterest(const Data& data, uint32_t sequenceNum)
+{
+  const InFlightWindow::Slot* interest = m_inFlightWindow.Find(sequenceNum);
+  if (interest == nullptr) {
+    return;
+  }
+
+  const Time now = ns3::Simulator::Now();
+  const Time lastSent = TimeStep(interest->lastSent);
+  int hopCount = 0;
+  const auto hopCountTag = data.getTag<lp::HopCountTag>();
+  if (hopCountTag != nullptr) {
+    hopCount = *hopCountTag;
+  }
+  m_lastRetransmittedInterestDataDelay(this, sequenceNum, now - lastSent, hopCount);
+  m_firstInterestDataDelay(this, sequenceNum, now - TimeStep(interest->firstSent),
+                           interest->sends, hopCount);
+
+  if (interest->state == InFlightWindow::OUTSTANDING) {
+    if (lastSent > m_highDataSentTime) {
+      m_highDataSentTime = lastSent;
+    }
+    if (interest->sends == 1) {
+      m_rtt->Measurement(now - lastSent);
+      m_rtt->ResetMultiplier();
+    }
+  }
+
+  m_retxSeqs.erase(sequenceNum);
+  m_inFlightWindow.Release(sequenceNum);
+}
+
+void
+ConsumerSrc::OnTimeout(uint32_t sequenceNum)
+{
+  // Reduce the window just once per loss episode
+  if (sequenceNum > m_recPoint) {
+    WindowDecrease();
+  }
+
+  m_inFlight = GetOutstanding();
+
+  m_timeoutTrace(sequenceNum, m_window, m_inFlight);
+
+  if (m_tracking == RING) {
+    // Consumer::OnTimeout, without its RTT history
+    m_rtt->IncreaseMultiplier();
+    m_retxSeqs.insert(sequenceNum);
+    ScheduleNextPacket();
+  }
+  else {
+    ns3::ndn::Consumer::OnTimeout(sequenceNum);
+  }
+}
+
+auto
+ConsumerSrc::CongestionDetected(const Data& data) noexcept -> bool
+{
+  const uint64_t congestionMark = data.getCongestionMark();
+  const mark::Kind kind = mark::GetKind(congestionMark);
+  if (kind == mark::UNKNOWN) {
+    // Written by a newer router
     return false;
   }
 
-  /* This is a security fallback: As this implementation does not retransmit
-   * lost packets, when there is a severe loss the simulation waits for all
-   * lost packets to timeout. This takes a lot of time and, basically means that
-   * the sender restarts in congestion avoidance with a window of 1 (after n
-   * timeouts). This usually happens during the slow-start phase, so, if the
-   * estimated queue grows grater than, lets say, 100 packets, it is a
-   * congestion event */
-  if (rInfo.GetDelay().GetSeconds() * rInfo.GetRate() > 100 * m_payloadSize
-      && m_window < m_ssthresh) {
-    return true;
+  const uint32_t routerId = mark::GetLinkId(congestionMark);
+  RouterStatus& rInfo = m_routerInfo.Get(routerId, ns3::Simulator::Now());
+
+  if (kind == mark::RATE) {
+    const double rate = mark::GetRate(congestionMark);
+
+    rInfo.SetRate(rate);
+    m_routerRateTrace(routerId, rate);
   }
+  else {
+    const Time delay = NanoSeconds(mark::GetDelayNs(congestionMark));
 
-  if (delay > MilliSeconds(5)) { // Codel high mark
-    const Time now = ns3::Simulator::Now();
+    rInfo.SetDelay(delay);
+    m_routerDelayTrace(routerId, delay);
+  }
 
-    if (rInfo.GetNextMarkTime() == Time::Max()) {
-      rInfo.SetNextMarkTime(now + rInfo.GetInterval());
+  // Each mark only reports one router, chosen at random along the path, so
+  // every known router runs its own CoDel state machine on every Data. If
+  // several of them are due to mark, the decision is taken against the binding
+  // bottleneck: the slowest one, where this flow is the most guilty. Routers
+  // not heard of in RouterTimeout have likely left the path and are ignored.
+  const Time now = ns3::Simulator::Now();
+  PathStatus path;
+  double bottleneckRate = 0;
+
+  m_routerInfo.ForEach(now, [&](RouterStatus& router) {
+    const double rate = router.GetRate();
+    const Time delay = router.GetDelay();
+
+    if (rate > 0 && (path.minRate == 0 || rate < path.minRate)) {
+      path.minRate = rate;
     }
-    else if (now > rInfo.GetNextMarkTime()) {
-      rInfo.IncCount();
-      const Time currentInterval =
-        Seconds(rInfo.GetInterval().GetSeconds() / sqrt(rInfo.GetCount() + 1));
 
-      rInfo.SetNextMarkTime(rInfo.GetNextMarkTime() + currentInterval);
+    if (rate == 0) {
+      return;
+    }
 
-      // FIXME: Maybe return congestion mark
-      const double sessRate =
-        m_window.Get() * m_payloadSize / m_rtt->GetCurrentEstimate().GetSeconds();
-      const double guilt = sessRate / rate;
+    if (delay > MilliSeconds(5)) { // Codel high mark
+      if (router.GetNextMarkTime() == Time::Max()) {
+        router.SetNextMarkTime(now + router.GetInterval());
+      }
+      else if (now > router.GetNextMarkTime()) {
+        router.IncCount();
+        router.SetNextMarkTime(router.GetNextMarkTime()
+                               + NanoSeconds(codel::CONTROL_LAW[router.GetCount()]));
+
+        if (bottleneckRate == 0 || rate < bottleneckRate) {
+          bottleneckRate = rate;
+        }
+      }
+    }
+    else if (router.GetNextMarkTime() != Time::Max()) {
+      router.SetNextMarkTime(Time::Max());
+      router.SetCount(0);
+    }
+  });
 
-      std::bernoulli_distribution congested(guilt);
+  m_path = path;
 
-      return congested(getRandomNumberEngine());
-    }
+  if (bottleneckRate == 0) {
+    return false;
   }
-  else if (rInfo.GetNextMarkTime() != Time::Max()) {
-    rInfo.SetNextMarkTime(Time::Max());
-    rInfo.SetCount(0);
+
+  // FIXME: Maybe return congestion mark
+  const double sessRate =
+    m_window.Get() * m_payloadSize / m_rtt->GetCurrentEstimate().GetSeconds();
+  const double guilt = sessRate / bottleneckRate;
+  if (guilt >= 1.0) {
+    return true;
   }
 
-  return false;
+  return m_random.Bernoulli(FastRandom::Threshold(guilt));
+}
+
+void
+ConsumerSrc::SetRouterTimeout(Time timeout)
+{
+  m_routerInfo.SetMaxAge(timeout);
+}
+
+auto
+ConsumerSrc::GetRouterTimeout() const -> Time
+{
+  return m_routerInfo.GetMaxAge();
 }
 
 auto
@@ -239,7 +579,7 @@ ConsumerSrc::RouterStatus::GetDelay() const -> Time
 ConsumerSrc::RouterStatus::RouterStatus(uint64_t rate, Time delay)
   : m_currentRate(rate)
   , m_currentDelay(std::move(delay))
-  , m_interval(MilliSeconds(100))
+  , m_interval(NanoSeconds(codel::INTERVAL_NS))
   , m_count(0)
   , m_nextMarkTime(Time::Max())
 {
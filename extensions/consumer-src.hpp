@@ -24,10 +24,30 @@
 
 #include <ns3/ndnSIM/apps/ndn-consumer-window.hpp>
 
+#include "fast-random.hpp"
+#include "in-flight-window.hpp"
+#include "router-table.hpp"
+
 namespace ns3 {
 namespace ndn {
 class ConsumerSrc : public ConsumerWindow {
 public:
+  /// Window growth algorithm. Both react to the congestion marks of the routers.
+  enum CcAlgorithm {
+    AIMD,
+    CUBIC,
+  };
+
+  /**
+   * Bookkeeping of the Interests in flight. CONTAINERS uses the containers of
+   * the ndnSIM Consumer, which allocate a node per Interest in each of them.
+   * RING uses an InFlightWindow and a single timeout timer.
+   */
+  enum InFlightTracking {
+    CONTAINERS,
+    RING,
+  };
+
   static auto GetTypeId() -> TypeId;
 
   ConsumerSrc();
@@ -36,9 +56,32 @@ public:
 
   void OnTimeout(uint32_t sequenceNum) override;
 
+  void WillSendOutInterest(uint32_t sequenceNum) override;
+
+  void ScheduleNextPacket() override;
+
+  typedef void (*RouterRateCallback)(uint32_t routerId, double rate);
+  typedef void (*RouterDelayCallback)(uint32_t routerId, Time delay);
+  typedef void (*CongestionEventCallback)(double window);
+  typedef void (*TimeoutCallback)(uint32_t sequenceNum, double window, uint32_t inFlight);
+
+protected:
+  void StartApplication() override;
+
+  void StopApplication() override;
+
 private:
   void WindowIncrease() noexcept;
   void WindowDecrease() noexcept;
+  void CubicIncrease() noexcept;
+  void CubicDecrease() noexcept;
+  auto DetectLosses() -> bool;
+  void ReleaseInterest(const Data& data, uint32_t sequenceNum);
+  void CheckTimeouts();
+  auto GetOutstanding() const -> uint32_t;
+  auto PacingInterval() const -> Time;
+  void SetRouterTimeout(Time timeout);
+  auto GetRouterTimeout() const -> Time;
   class RouterStatus {
   public:
     explicit RouterStatus(uint64_t rate = 0, Time delay = Seconds(0));
@@ -73,24 +116,49 @@ private:
     Time m_nextMarkTime;
   };
 
-  std::map<uint32_t, RouterStatus> m_routerInfo;
+  RouterTable<RouterStatus> m_routerInfo;
+
+  /// Path-wide view of the known routers, refreshed with every Data
+  struct PathStatus {
+    double minRate = 0; ///< Slowest router, in bytes/s. 0 until a rate is known.
+  };
+
+  PathStatus m_path;
 
   auto CongestionDetected(const Data& data) noexcept -> bool;
 
+  CcAlgorithm m_ccAlgorithm;
   TracedValue<double> m_ssthresh;
   uint32_t m_highData;
   double m_recPoint;
+  uint32_t m_reorderThreshold;
+  Time m_highDataSentTime; // Send time of the newest Interest answered so far
   double m_beta;
   double m_addRttSuppress;
-  bool dumpCongestion;
+  bool m_pacing;
+  Time m_nextSendTime;
+
+  InFlightTracking m_tracking;
+  InFlightWindow m_inFlightWindow; // Only with RING
+  EventId m_timeoutEvent;
+
+  TracedCallback<uint32_t, double> m_routerRateTrace;
+  TracedCallback<uint32_t, Time> m_routerDelayTrace;
+  TracedCallback<double> m_congestionEventTrace;
+  TracedCallback<uint32_t, double, uint32_t> m_timeoutTrace;
 
   // TCP CUBIC Parameters //
   static constexpr double CUBIC_C = 0.4;
   static constexpr double m_cubicBeta = 0.7;
 
+  bool m_cubicFastConvergence;
   double m_cubicWmax;
   double m_cubicLastWmax;
   Time m_cubicLastDecrease;
+
+  // Marking decisions. Seeded when the application starts, from the run
+  // number, the node name and the prefix.
+  FastRandom m_random;
 };
 } // namespace ndn
 } // namespace ns3
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "data-template.hpp"
+
+#include <algorithm>
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+/// Writes a TLV type or length (VAR-NUMBER) and returns the end of it
+auto
+writeVarNumber(uint8_t* out, uint64_t number) -> uint8_t*
+{
+  if (number < 253) {
+    *out++ = static_cast<uint8_t>(number);
+    return out;
+  }
+
+  unsigned bytes = 8;
+  if (number <= 0xFFFF) {
+    *out++ = 253;
+    bytes = 2;
+  }
+  else if (number <= 0xFFFFFFFF) {
+    *out++ = 254;
+    bytes = 4;
+  }
+  else {
+    *out++ = 255;
+  }
+  for (unsigned i = bytes; i > 0; i--) {
+    *out++ = static_cast<uint8_t>(number >> (8 * (i - 1)));
+  }
+
+  return out;
+}
+} // namespace
+
+DataTemplate::DataTemplate()
+  : DataTemplate(1024, Seconds(0), 0, Name())
+{
+}
+
+DataTemplate::DataTemplate(uint32_t payloadSize, Time freshness, uint32_t signature,
+                           const Name& keyLocator)
+{
+  const auto data = Encode(Name(), payloadSize, freshness, signature, keyLocator);
+  const Block& wire = data->wireEncode();
+  wire.parse();
+  const Block& name = wire.get(::ndn::tlv::Name);
+  m_tail = make_shared<::ndn::Buffer>(name.end(), wire.end());
+}
+
+auto
+DataTemplate::Make(const Name& name) const -> shared_ptr<Data>
+{
+  // The layout of Data::wireEncode(): type, length, the name and the rest
+  const Block& nameWire = name.wireEncode();
+  const size_t length = nameWire.size() + m_tail->size();
+  auto wire = make_shared<::ndn::Buffer>(::ndn::tlv::sizeOfVarNumber(::ndn::tlv::Data)
+                                         + ::ndn::tlv::sizeOfVarNumber(length) + length);
+  uint8_t* out = wire->data();
+  out = writeVarNumber(out, ::ndn::tlv::Data);
+  out = writeVarNumber(out, length);
+  out = std::copy(nameWire.begin(), nameWire.end(), out);
+  std::copy(m_tail->begin(), m_tail->end(), out);
+
+  return make_shared<Data>(Block(wire));
+}
+
+auto
+DataTemplate::Encode(const Name& name, uint32_t payloadSize, Time freshness, uint32_t signature,
+                     const Name& keyLocator) -> shared_ptr<Data>
+{
+  auto data = make_shared<Data>();
+  data->setName(name);
+  data->setFreshnessPeriod(::ndn::time::milliseconds(freshness.GetMilliSeconds()));
+  data->setContent(make_shared<::ndn::Buffer>(payloadSize));
+
+  Signature fakeSignature;
+  SignatureInfo signatureInfo(static_cast<::ndn::tlv::SignatureTypeValue>(255));
+  if (keyLocator.size() > 0) {
+    signatureInfo.setKeyLocator(keyLocator);
+  }
+  fakeSignature.setInfo(signatureInfo);
+  fakeSignature.setValue(
+    ::ndn::makeNonNegativeIntegerBlock(::ndn::tlv::SignatureValue, signature));
+  data->setSignature(fakeSignature);
+
+  data->wireEncode();
+  return data;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,61 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_DATA_TEMPLATE_H
+#define NDN_DATA_TEMPLATE_H
+
+#include <ns3/ndnSIM/model/ndn-common.hpp>
+
+#include <ns3/nstime.h>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Data packets of ns3::ndn::Producer, built from a pre-encoded template.
+ *
+ * Everything after the name of a Data (MetaInfo, the Content with the virtual
+ * payload and the fake signature) is the same for every Interest, so it is
+ * encoded once. Each Data is then the TLV header, the wire encoding of the
+ * Interest name (with the sequence number already in it) and a copy of that
+ * template, decoded in place. The result is byte for byte the Data Producer
+ * encodes, without allocating and zeroing a payload or encoding the Data
+ * element by element.
+ */
+class DataTemplate {
+public:
+  DataTemplate();
+
+  /// Same parameters as the attributes of Producer
+  DataTemplate(uint32_t payloadSize, Time freshness, uint32_t signature, const Name& keyLocator);
+
+  /// Data for the name of an Interest
+  auto Make(const Name& name) const -> shared_ptr<Data>;
+
+  /// Data built as Producer::OnInterest() does. Slower, for comparison.
+  static auto Encode(const Name& name, uint32_t payloadSize, Time freshness, uint32_t signature,
+                     const Name& keyLocator) -> shared_ptr<Data>;
+
+private:
+  ::ndn::ConstBufferPtr m_tail; ///< Wire encoding of a Data after its name
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_DATA_TEMPLATE_H
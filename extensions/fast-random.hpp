@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_FAST_RANDOM_H
+#define NDN_FAST_RANDOM_H
+
+#include <cstdint>
+#include <string>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Small xoshiro256** generator for the per-packet random decisions of the
+ * links (see extras/) and of ConsumerSrc, so this header must not depend on
+ * ns-3.
+ *
+ * Each link and consumer owns one, seeded from the ns-3 seed and run number
+ * and from a stable name of its owner (see StreamId()). So its decisions do
+ * not depend on the order in which other objects draw numbers, and stay the
+ * same when unrelated nodes are added to the topology.
+ */
+class FastRandom {
+public:
+  explicit FastRandom(uint64_t seed = 0, uint64_t run = 0, uint64_t stream = 0) noexcept
+  {
+    Seed(seed, run, stream);
+  }
+
+  void
+  Seed(uint64_t seed, uint64_t run, uint64_t stream) noexcept
+  {
+    // SplitMix64 expands the seed, as recommended by the xoshiro authors
+    uint64_t x = SplitMix(SplitMix(SplitMix(seed) ^ run) ^ stream);
+    for (auto& word : m_state) {
+      x += 0x9E3779B97F4A7C15ULL;
+      word = SplitMix(x);
+    }
+  }
+
+  auto
+  operator()() noexcept -> uint64_t
+  {
+    const uint64_t result = Rotl(m_state[1] * 5, 7) * 9;
+    const uint64_t t = m_state[1] << 17U;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= t;
+    m_state[3] = Rotl(m_state[3], 45);
+
+    return result;
+  }
+
+  /// Threshold for Bernoulli(): probability scaled to 2^32. Probabilities over 1 always succeed.
+  static constexpr auto
+  Threshold(double probability) noexcept -> uint64_t
+  {
+    return probability >= 1   ? 1ULL << 32U
+           : probability <= 0 ? 0
+                              : static_cast<uint64_t>(probability * 4294967296.0);
+  }
+
+  /// True with probability threshold / 2^32
+  auto
+  Bernoulli(uint64_t threshold) noexcept -> bool
+  {
+    return ((*this)() >> 32U) < threshold;
+  }
+
+  /// True with probability 1 / n
+  auto
+  OneIn(uint64_t n) noexcept -> bool
+  {
+    return ((*this)() >> 32U) * n < (1ULL << 32U);
+  }
+
+  /// Stable identifier of a random stream, from the name of its owner (FNV-1a)
+  static auto
+  StreamId(const std::string& name) noexcept -> uint64_t
+  {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (const unsigned char c : name) {
+      hash = (hash ^ c) * 0x100000001B3ULL;
+    }
+
+    return hash;
+  }
+
+private:
+  static constexpr auto
+  Rotl(uint64_t x, unsigned k) noexcept -> uint64_t
+  {
+    return (x << k) | (x >> (64U - k));
+  }
+
+  static constexpr auto
+  SplitMix(uint64_t x) noexcept -> uint64_t
+  {
+    x = (x ^ (x >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27U)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31U);
+  }
+
+  uint64_t m_state[4];
+};
+
+static_assert(FastRandom::Threshold(1) == 1ULL << 32U, "Certain events always succeed");
+static_assert(FastRandom::Threshold(0.25) == 1ULL << 30U, "Threshold scale");
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_FAST_RANDOM_H
@@ -0,0 +1,90 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "flow-spec.hpp"
+
+#include <ns3/fatal-error.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+namespace ndn {
+
+FlowSpec::FlowSpec(const std::string& fileName)
+{
+  std::ifstream file(fileName);
+  NS_ABORT_MSG_IF(!file, "Cannot open flow specification " << fileName);
+
+  std::string line;
+  for (unsigned lineNumber = 1; std::getline(file, line); lineNumber++) {
+    std::istringstream fields(line.substr(0, line.find('#')));
+    std::string directive;
+    if (!(fields >> directive)) {
+      continue;
+    }
+
+    if (directive == "flow") {
+      Flow flow;
+      std::string start, stop;
+      NS_ABORT_MSG_UNLESS(fields >> flow.consumer >> flow.producer >> start >> stop,
+                          fileName << ':' << lineNumber
+                                   << ": expected flow CONSUMER PRODUCER START STOP");
+      flow.start = Time(start);
+      flow.stop = Time(stop);
+      NS_ABORT_MSG_IF(flow.stop <= flow.start,
+                      fileName << ':' << lineNumber << ": flow stops before it starts");
+
+      std::string attribute;
+      while (fields >> attribute) {
+        const auto equal = attribute.find('=');
+        NS_ABORT_MSG_IF(equal == std::string::npos || equal == 0,
+                        fileName << ':' << lineNumber << ": expected Attribute=Value, got "
+                                 << attribute);
+        flow.attributes.emplace_back(attribute.substr(0, equal), attribute.substr(equal + 1));
+      }
+
+      m_flows.push_back(std::move(flow));
+    }
+    else if (directive == "queue") {
+      Queue queue;
+      NS_ABORT_MSG_UNLESS(fields >> queue.node >> queue.device,
+                          fileName << ':' << lineNumber << ": expected queue NODE DEVICE");
+
+      m_queues.push_back(std::move(queue));
+    }
+    else {
+      NS_FATAL_ERROR(fileName << ':' << lineNumber << ": unknown directive " << directive);
+    }
+  }
+}
+
+auto
+FlowSpec::GetStopTime() const noexcept -> Time
+{
+  Time stop = Seconds(0);
+  for (const auto& flow : m_flows) {
+    stop = std::max(stop, flow.stop);
+  }
+
+  return stop;
+}
+
+} // namespace ndn
+} // namespace ns3
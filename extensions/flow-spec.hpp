@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_FLOW_SPEC_H
+#define NDN_FLOW_SPEC_H
+
+#include <ns3/nstime.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Traffic of a data-driven scenario, read from a flow specification file.
+ *
+ * Each line holds a directive. Empty lines and text after a '#' are ignored.
+ *
+ *     # consumer producer start stop [Attribute=Value...]
+ *     flow C1 P1 0s 100s CcAlgorithm=CUBIC
+ *     # node device
+ *     queue R1 0
+ *
+ * Flow attributes are set on the consumer application. Queues are traced on
+ * the transmission queue of the given device of the node.
+ */
+class FlowSpec {
+public:
+  struct Flow {
+    std::string consumer;
+    std::string producer;
+    Time start;
+    Time stop;
+    std::vector<std::pair<std::string, std::string>> attributes;
+  };
+
+  struct Queue {
+    std::string node;
+    uint32_t device;
+  };
+
+  /// Reads a specification file. Aborts on syntax errors.
+  explicit FlowSpec(const std::string& fileName);
+
+  auto
+  GetFlows() const noexcept -> const std::vector<Flow>&
+  {
+    return m_flows;
+  }
+
+  auto
+  GetQueues() const noexcept -> const std::vector<Queue>&
+  {
+    return m_queues;
+  }
+
+  /// Time the last flow stops
+  auto GetStopTime() const noexcept -> Time;
+
+private:
+  std::vector<Flow> m_flows;
+  std::vector<Queue> m_queues;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_FLOW_SPEC_H
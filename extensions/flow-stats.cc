@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "flow-stats.hpp"
+
+#include <ns3/fatal-error.h>
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+void
+printDelays(std::ostream& os, const char* name, const QuantileSketch& delays)
+{
+  os << name << " delay (ms): mean " << delays.GetMean() * 1e3;
+  for (double q : {0.5, 0.9, 0.99, 0.999}) {
+    os << "  p" << q * 100 << ' ' << delays.Quantile(q) * 1e3;
+  }
+  os << "  max " << delays.GetMax() * 1e3 << "  (" << delays.GetCount() << " samples)\n";
+}
+} // namespace
+
+FlowStats::FlowStats(Time window)
+  : m_window(window.GetNanoSeconds())
+  , m_windowEnd(m_window)
+  , m_windows(0)
+{
+  NS_ABORT_MSG_IF(m_window <= 0, "Statistics windows must have a positive length");
+}
+
+auto
+FlowStats::AddFlow(const std::string& name) -> uint32_t
+{
+  m_flows.emplace_back();
+  m_flows.back().name = name;
+  m_windowBytes.push_back(0);
+
+  return m_flows.size() - 1;
+}
+
+void
+FlowStats::CloseWindow()
+{
+  m_history.emplace_back();
+  auto& window = m_history.back();
+  window.reserve(m_active.size());
+  for (uint32_t flow : m_active) {
+    window.emplace_back(flow, m_windowBytes[flow]);
+    m_windowBytes[flow] = 0;
+  }
+  m_active.clear();
+
+  m_windows++;
+  m_windowEnd += m_window;
+}
+
+auto
+FlowStats::Fairness(uint32_t window) const -> double
+{
+  // Flows that got nothing in the window count as long as they were active
+  // before and after it
+  uint32_t active = 0;
+  for (const auto& flow : m_flows) {
+    if (flow.bytes > 0 && flow.firstWindow <= window && window <= flow.lastWindow) {
+      active++;
+    }
+  }
+
+  double sum = 0;
+  double squares = 0;
+  for (const auto& entry : m_history[window]) {
+    sum += entry.second;
+    squares += static_cast<double>(entry.second) * entry.second;
+  }
+
+  return squares > 0 ? sum * sum / (active * squares) : 0;
+}
+
+void
+FlowStats::PrintSummary(std::ostream& os)
+{
+  const auto precision = os.precision(4);
+
+  os << "Flow\tBytes\tGoodput (Mbps)\tFirst data (s)\tLast data (s)\n";
+  for (const auto& flow : m_flows) {
+    const double duration = (flow.lastTime - flow.firstTime) / 1e9;
+    os << flow.name << '\t' << flow.bytes << '\t'
+       << (duration > 0 ? flow.bytes * 8 / duration / 1e6 : 0) << '\t' << flow.firstTime / 1e9
+       << '\t' << flow.lastTime / 1e9 << '\n';
+  }
+
+  double sum = 0;
+  double lowest = 1;
+  uint32_t windows = 0;
+  for (uint32_t window = 0; window < m_history.size(); window++) {
+    if (!m_history[window].empty()) {
+      const double fairness = Fairness(window);
+      sum += fairness;
+      lowest = std::min(lowest, fairness);
+      windows++;
+    }
+  }
+  os << "Fairness (Jain, " << m_window / 1e9 << "s windows): mean "
+     << (windows > 0 ? sum / windows : 0) << "  min " << (windows > 0 ? lowest : 0) << '\n';
+
+  printDelays(os, "App", m_appDelay);
+  printDelays(os, "Queue", m_queueDelay);
+
+  os.precision(precision);
+}
+
+void
+FlowStats::WriteTimeSeries(const std::string& throughputFile, const std::string& fairnessFile)
+{
+  std::ofstream throughput(throughputFile);
+  std::ofstream fairness(fairnessFile);
+  NS_ABORT_MSG_IF(!throughput || !fairness,
+                  "Cannot create " << throughputFile << " or " << fairnessFile);
+
+  throughput << "Time\tFlow\tGoodput\n";
+  fairness << "Time\tFairness\n";
+
+  for (uint32_t window = 0; window < m_history.size(); window++) {
+    const double time = (window + 1) * m_window / 1e9;
+    if (m_history[window].empty()) {
+      continue;
+    }
+
+    for (const auto& entry : m_history[window]) {
+      throughput << time << '\t' << m_flows[entry.first].name << '\t'
+                 << entry.second * 1e9 / m_window << '\n';
+    }
+    fairness << time << '\t' << Fairness(window) << '\n';
+  }
+}
+
+} // namespace ndn
+} // namespace ns3
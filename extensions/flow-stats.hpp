@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_FLOW_STATS_H
+#define NDN_FLOW_STATS_H
+
+#include "quantile-sketch.hpp"
+
+#include <ns3/nstime.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/simulator.h>
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Statistics computed while the simulation runs, so that the per-packet traces
+ * are not needed to get them.
+ *
+ * Keeps the goodput of every flow in windows of fixed length, Jain's fairness
+ * index of each window and quantile sketches of the application delay and of
+ * the queueing delay reported by the routers.
+ */
+class FlowStats : public SimpleRefCount<FlowStats> {
+public:
+  /// \param window Length of the throughput windows
+  explicit FlowStats(Time window = Seconds(1));
+
+  /// Registers a flow and returns the identifier to use with OnData
+  auto AddFlow(const std::string& name) -> uint32_t;
+
+  void
+  OnData(uint32_t flow, uint32_t bytes)
+  {
+    const int64_t now = Simulator::Now().GetNanoSeconds();
+    while (now >= m_windowEnd) {
+      CloseWindow();
+    }
+
+    Flow& stats = m_flows[flow];
+    if (stats.bytes == 0) {
+      stats.firstWindow = m_windows;
+      stats.firstTime = now;
+    }
+    stats.lastWindow = m_windows;
+    stats.lastTime = now;
+    stats.bytes += bytes;
+    if (m_windowBytes[flow] == 0) {
+      m_active.push_back(flow);
+    }
+    m_windowBytes[flow] += bytes;
+  }
+
+  void
+  OnAppDelay(Time delay)
+  {
+    m_appDelay.Add(delay.GetSeconds());
+  }
+
+  void
+  OnQueueDelay(Time delay)
+  {
+    m_queueDelay.Add(delay.GetSeconds());
+  }
+
+  /// Prints a summary of each flow, the fairness and the delay percentiles
+  void PrintSummary(std::ostream& os);
+
+  /**
+   * Writes the time series of the complete windows: the goodput (bytes/s) of
+   * each flow that got data (time, flow, goodput) and the fairness index
+   * (time, index), both with a header line. Times are those of the end of
+   * the windows.
+   */
+  void WriteTimeSeries(const std::string& throughputFile, const std::string& fairnessFile);
+
+private:
+  struct Flow {
+    std::string name;
+    uint64_t bytes = 0;
+    uint32_t firstWindow = 0;
+    uint32_t lastWindow = 0;
+    int64_t firstTime = 0;
+    int64_t lastTime = 0;
+  };
+
+  void CloseWindow();
+
+  /// Fairness of the flows active in a window. Includes the flows that got nothing in it.
+  auto Fairness(uint32_t window) const -> double;
+
+  const int64_t m_window; // Nanoseconds
+  int64_t m_windowEnd;
+  uint32_t m_windows; // Closed windows
+
+  std::vector<Flow> m_flows;
+  std::vector<uint64_t> m_windowBytes;
+  std::vector<uint32_t> m_active; // Flows with data in the current window
+
+  // Flows that got data in each closed window, with their bytes. Sparse, as
+  // most flows are idle most of the time in large scenarios.
+  std::vector<std::vector<std::pair<uint32_t, uint64_t>>> m_history;
+
+  QuantileSketch m_appDelay;
+  QuantileSketch m_queueDelay;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_FLOW_STATS_H
@@ -0,0 +1,289 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_IN_FLIGHT_WINDOW_H
+#define NDN_IN_FLIGHT_WINDOW_H
+
+#include <ns3/nstime.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Interests a consumer is waiting Data for, without an allocation per Interest.
+ *
+ * Sequence numbers from the lowest unanswered one to the highest sent one are
+ * kept in a ring indexed by the sequence number, which doubles when the range
+ * does not fit. Every transmission is also appended to a FIFO of send times,
+ * which is thus ordered by time. Expire() pops it from the front, discarding
+ * the records of Interests that were answered or sent again since, so a single
+ * periodic timer finds the timeouts, as the ndnSIM Consumer does with its
+ * containers.
+ *
+ * An Interest is outstanding from its transmission until its Data arrives, it
+ * times out or it is declared lost. Lost Interests are kept (for the delay of
+ * their Data) until Release().
+ */
+class InFlightWindow {
+public:
+  enum State : uint8_t {
+    FREE,
+    OUTSTANDING,
+    LOST, ///< Timed out or lost, waiting to be sent again
+  };
+
+  struct Slot {
+    uint32_t seq = 0;
+    State state = FREE;
+    uint32_t sends = 0;    ///< Transmissions of the Interest
+    int64_t firstSent = 0; ///< Time steps
+    int64_t lastSent = 0;  ///< Time steps
+  };
+
+  explicit InFlightWindow(size_t capacity = 64)
+    : m_slots(RoundUp(capacity))
+    , m_low(0)
+    , m_high(0)
+    , m_scan(0)
+    , m_outstanding(0)
+    , m_sends(RoundUp(capacity))
+    , m_sendHead(0)
+    , m_sendSize(0)
+  {
+  }
+
+  /// An Interest was sent, for the first time or again
+  void
+  OnSend(uint32_t seq, Time now)
+  {
+    if (m_low == m_high) {
+      m_low = m_high = m_scan = seq;
+    }
+    if (seq < m_low) {
+      Reserve(m_high - seq);
+      m_low = seq;
+    }
+    else if (seq >= m_high) {
+      Reserve(seq + 1 - m_low);
+      m_high = seq + 1;
+    }
+
+    Slot& slot = At(seq);
+    if (slot.state == FREE) {
+      slot.seq = seq;
+      slot.sends = 0;
+      slot.firstSent = now.GetTimeStep();
+    }
+    if (slot.state != OUTSTANDING) {
+      slot.state = OUTSTANDING;
+      m_outstanding++;
+    }
+    slot.sends++;
+    slot.lastSent = now.GetTimeStep();
+    if (seq < m_scan) {
+      m_scan = seq;
+    }
+
+    if (m_sendSize == m_sends.size()) {
+      GrowSends();
+    }
+    m_sends[(m_sendHead + m_sendSize) & (m_sends.size() - 1)] = SendRecord{seq, slot.lastSent};
+    m_sendSize++;
+  }
+
+  /// Interest waiting for Data, or nullptr if it is not known
+  auto
+  Find(uint32_t seq) const -> const Slot*
+  {
+    if (seq < m_low || seq >= m_high) {
+      return nullptr;
+    }
+    const Slot& slot = m_slots[seq & (m_slots.size() - 1)];
+
+    return slot.state == FREE ? nullptr : &slot;
+  }
+
+  /// Data arrived, forget the Interest
+  void
+  Release(uint32_t seq)
+  {
+    if (Find(seq) == nullptr) {
+      return;
+    }
+
+    Slot& slot = At(seq);
+    if (slot.state == OUTSTANDING) {
+      m_outstanding--;
+    }
+    slot.state = FREE;
+
+    while (m_low < m_high && At(m_low).state == FREE) {
+      m_low++;
+    }
+    if (m_scan < m_low) {
+      m_scan = m_low;
+    }
+  }
+
+  /**
+   * Declares lost the outstanding Interests sent before \p deadline, in the
+   * order they were sent, calling \p onExpired with their sequence numbers.
+   */
+  template <typename F>
+  void
+  Expire(Time deadline, F onExpired)
+  {
+    const int64_t limit = deadline.GetTimeStep();
+
+    while (m_sendSize > 0 && m_sends[m_sendHead].time <= limit) {
+      const SendRecord record = m_sends[m_sendHead];
+      m_sendHead = (m_sendHead + 1) & (m_sends.size() - 1);
+      m_sendSize--;
+
+      // Otherwise answered, lost or sent again since this record
+      const Slot* slot = Find(record.seq);
+      if (slot != nullptr && slot->state == OUTSTANDING && slot->lastSent == record.time) {
+        MarkLost(record.seq);
+        onExpired(record.seq);
+      }
+    }
+  }
+
+  /**
+   * Declares lost the outstanding Interests up to \p seq (included) that were
+   * last sent before \p sentBefore, calling \p onLost with their sequence
+   * numbers in increasing order.
+   */
+  template <typename F>
+  void
+  ExpireUpTo(uint32_t seq, Time sentBefore, F onLost)
+  {
+    const int64_t limit = sentBefore.GetTimeStep();
+    const uint32_t end = seq < m_high ? seq + 1 : m_high;
+    uint32_t firstOutstanding = end;
+
+    // Interests below m_scan are not outstanding, so each one is visited once
+    // until it is sent again
+    for (uint32_t i = std::max(m_scan, m_low); i < end; i++) {
+      const Slot& slot = At(i);
+      if (slot.state != OUTSTANDING) {
+        continue;
+      }
+      if (slot.lastSent < limit) {
+        MarkLost(i);
+        onLost(i);
+      }
+      else if (firstOutstanding == end) {
+        firstOutstanding = i;
+      }
+    }
+    if (firstOutstanding > m_scan) {
+      m_scan = firstOutstanding;
+    }
+  }
+
+  /// Interests sent and neither answered nor lost
+  auto
+  GetOutstanding() const -> uint32_t
+  {
+    return m_outstanding;
+  }
+
+  /// Whether Expire() has send records to check
+  auto
+  HasPending() const -> bool
+  {
+    return m_sendSize > 0;
+  }
+
+private:
+  struct SendRecord {
+    uint32_t seq;
+    int64_t time;
+  };
+
+  static auto
+  RoundUp(size_t capacity) -> size_t
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1U;
+    }
+
+    return size;
+  }
+
+  auto
+  At(uint32_t seq) -> Slot&
+  {
+    return m_slots[seq & (m_slots.size() - 1)];
+  }
+
+  void
+  MarkLost(uint32_t seq)
+  {
+    At(seq).state = LOST;
+    m_outstanding--;
+  }
+
+  /// Makes room for a range of sequence numbers. Slots out of the range are free.
+  void
+  Reserve(size_t range)
+  {
+    if (range <= m_slots.size()) {
+      return;
+    }
+
+    std::vector<Slot> slots(RoundUp(range));
+    for (uint32_t seq = m_low; seq != m_high; seq++) {
+      slots[seq & (slots.size() - 1)] = At(seq);
+    }
+    m_slots.swap(slots);
+  }
+
+  void
+  GrowSends()
+  {
+    std::vector<SendRecord> sends(m_sends.size() * 2);
+    for (size_t i = 0; i < m_sendSize; i++) {
+      sends[i] = m_sends[(m_sendHead + i) & (m_sends.size() - 1)];
+    }
+    m_sends.swap(sends);
+    m_sendHead = 0;
+  }
+
+  std::vector<Slot> m_slots; ///< Its size is a power of 2
+  uint32_t m_low;            ///< Lowest sequence number not answered
+  uint32_t m_high;           ///< One past the highest sequence number sent
+  uint32_t m_scan;           ///< No outstanding Interest below it
+  uint32_t m_outstanding;
+
+  std::vector<SendRecord> m_sends; ///< FIFO of transmissions. Its size is a power of 2.
+  size_t m_sendHead;
+  size_t m_sendSize;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_IN_FLIGHT_WINDOW_H
@@ -0,0 +1,291 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "ladder-scheduler.hpp"
+
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+namespace {
+// Buckets with more events are split into a new rung instead of sorted
+constexpr size_t BUCKET_THRESHOLD = 50;
+// The bottom list is turned into a rung when it grows beyond this
+constexpr size_t BOTTOM_THRESHOLD = 4 * BUCKET_THRESHOLD;
+constexpr size_t MAX_RUNGS = 8;
+// The top list is spread into a bucket per event, up to this number
+constexpr size_t MAX_BUCKETS = 1U << 16U;
+
+/// Removes the event with the same uid from an unsorted list
+auto
+removeUnsorted(std::vector<Scheduler::Event>& events, uint32_t uid) -> bool
+{
+  for (auto& event : events) {
+    if (event.key.m_uid == uid) {
+      event = events.back();
+      events.pop_back();
+      return true;
+    }
+  }
+
+  return false;
+}
+} // namespace
+
+auto
+LadderScheduler::GetTypeId() -> TypeId
+{
+  static TypeId tid = TypeId("ns3::ndn::LadderScheduler")
+                        .SetParent<Scheduler>()
+                        .SetGroupName("Ndn")
+                        .AddConstructor<LadderScheduler>();
+
+  return tid;
+}
+
+LadderScheduler::LadderScheduler()
+  : m_topStart(0)
+  , m_topMin(std::numeric_limits<uint64_t>::max())
+  , m_topMax(0)
+  , m_rungs(MAX_RUNGS) // Never reallocated, so references to rungs stay valid
+  , m_nRungs(0)
+  , m_size(0)
+{
+}
+
+LadderScheduler::~LadderScheduler() = default;
+
+void
+LadderScheduler::Insert(const Event& ev)
+{
+  const uint64_t ts = ev.key.m_ts;
+  m_size++;
+
+  if (ts >= m_topStart) {
+    m_top.push_back(ev);
+    m_topMin = std::min(m_topMin, ts);
+    m_topMax = std::max(m_topMax, ts);
+    return;
+  }
+
+  for (size_t i = 0; i < m_nRungs; i++) {
+    Rung& rung = m_rungs[i];
+    if (ts >= rung.CurrentStart()) {
+      rung.buckets[(ts - rung.start) / rung.width].push_back(ev);
+      rung.count++;
+      return;
+    }
+  }
+
+  InsertBottom(ev);
+  // Many events for the very near future. Spread them unless they are simultaneous.
+  if (m_bottom.size() > BOTTOM_THRESHOLD && m_nRungs < MAX_RUNGS
+      && m_bottom.front().key.m_ts != m_bottom.back().key.m_ts) {
+    const uint64_t end = m_nRungs > 0 ? m_rungs[m_nRungs - 1].CurrentStart() : m_topStart;
+    Spawn(m_bottom, m_bottom.back().key.m_ts, end);
+  }
+}
+
+auto
+LadderScheduler::IsEmpty() const -> bool
+{
+  return m_size == 0;
+}
+
+auto
+LadderScheduler::PeekNext() const -> Event
+{
+  NS_ASSERT(m_size > 0);
+
+  // Finding the next event reorganizes the ladder, but not the order of the events
+  if (m_bottom.empty()) {
+    const_cast<LadderScheduler*>(this)->RefillBottom();
+  }
+
+  return m_bottom.back();
+}
+
+auto
+LadderScheduler::RemoveNext() -> Event
+{
+  NS_ASSERT(m_size > 0);
+
+  if (m_bottom.empty()) {
+    RefillBottom();
+  }
+
+  const Event ev = m_bottom.back();
+  m_bottom.pop_back();
+  m_size--;
+
+  // Start over, the next events may be anywhere
+  if (m_size == 0) {
+    m_topStart = 0;
+    m_nRungs = 0;
+  }
+
+  return ev;
+}
+
+void
+LadderScheduler::Remove(const Event& ev)
+{
+  const uint64_t ts = ev.key.m_ts;
+  bool found = false;
+
+  if (ts >= m_topStart) {
+    found = removeUnsorted(m_top, ev.key.m_uid);
+  }
+  else {
+    size_t i = 0;
+    while (i < m_nRungs && ts < m_rungs[i].CurrentStart()) {
+      i++;
+    }
+
+    if (i < m_nRungs) {
+      Rung& rung = m_rungs[i];
+      found = removeUnsorted(rung.buckets[(ts - rung.start) / rung.width], ev.key.m_uid);
+      rung.count -= found ? 1 : 0;
+    }
+    else {
+      const auto event =
+        std::find_if(m_bottom.begin(), m_bottom.end(),
+                     [&ev](const Event& other) { return other.key.m_uid == ev.key.m_uid; });
+      found = event != m_bottom.end();
+      if (found) {
+        m_bottom.erase(event);
+      }
+    }
+  }
+  NS_ASSERT_MSG(found, "Event " << ev.key.m_uid << " is not scheduled");
+
+  m_size--;
+  if (m_size == 0) {
+    m_top.clear();
+    m_topMin = std::numeric_limits<uint64_t>::max();
+    m_topMax = 0;
+    m_topStart = 0;
+    m_nRungs = 0;
+  }
+}
+
+void
+LadderScheduler::Spawn(std::vector<Event>& events, uint64_t start, uint64_t end)
+{
+  NS_ASSERT(m_nRungs < MAX_RUNGS && start < end);
+
+  Rung& rung = m_rungs[m_nRungs++];
+  rung.nBuckets = std::min(events.size(), MAX_BUCKETS);
+  rung.width = (end - start - 1) / rung.nBuckets + 1;
+  rung.start = start;
+  rung.current = 0;
+  rung.count = events.size();
+  if (rung.buckets.size() < rung.nBuckets) {
+    rung.buckets.resize(rung.nBuckets);
+  }
+
+  for (const Event& event : events) {
+    rung.buckets[(event.key.m_ts - start) / rung.width].push_back(event);
+  }
+  events.clear();
+}
+
+void
+LadderScheduler::RefillBottom()
+{
+  NS_ASSERT(m_bottom.empty());
+
+  while (true) {
+    if (m_nRungs == 0) {
+      Spawn(m_top, m_topMin, m_topMax + 1);
+      m_topStart = m_rungs[0].start + m_rungs[0].nBuckets * m_rungs[0].width;
+      m_topMin = std::numeric_limits<uint64_t>::max();
+      m_topMax = 0;
+    }
+
+    Rung& rung = m_rungs[m_nRungs - 1];
+    if (rung.count == 0) {
+      m_nRungs--;
+      continue;
+    }
+
+    while (rung.buckets[rung.current].empty()) {
+      rung.current++;
+    }
+    std::vector<Event>& bucket = rung.buckets[rung.current];
+    const uint64_t bucketStart = rung.CurrentStart();
+    rung.current++;
+    rung.count -= bucket.size();
+
+    if (bucket.size() > BUCKET_THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS) {
+      Spawn(bucket, bucketStart, bucketStart + rung.width);
+      continue;
+    }
+
+    // The bucket gets the storage of the bottom list, so nothing is allocated
+    m_bottom.swap(bucket);
+    std::sort(m_bottom.begin(), m_bottom.end(),
+              [](const Event& a, const Event& b) { return b.key < a.key; });
+    return;
+  }
+}
+
+void
+LadderScheduler::InsertBottom(const Event& ev)
+{
+  // Usually scheduled right now, so it goes at (or close to) the end
+  auto position = m_bottom.end();
+  while (position != m_bottom.begin() && (position - 1)->key < ev.key) {
+    --position;
+  }
+  m_bottom.insert(position, ev);
+}
+
+void
+SelectScheduler(const std::string& name)
+{
+  static const std::map<std::string, std::string> schedulers{
+    {"map", "ns3::MapScheduler"},
+    {"heap", "ns3::HeapScheduler"},
+    {"list", "ns3::ListScheduler"},
+    {"calendar", "ns3::CalendarScheduler"},
+    {"ladder", "ns3::ndn::LadderScheduler"},
+  };
+
+  const auto known = schedulers.find(name);
+  const std::string typeName = known != schedulers.end() ? known->second : name;
+  TypeId tid;
+  NS_ABORT_MSG_IF(!TypeId::LookupByNameFailSafe(typeName, &tid), "Unknown scheduler " << name);
+
+  ObjectFactory factory;
+  factory.SetTypeId(tid);
+  Simulator::SetScheduler(factory);
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_LADDER_SCHEDULER_H
+#define NDN_LADDER_SCHEDULER_H
+
+#include <ns3/scheduler.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Ladder queue event scheduler (Tang, Goh and Thng, ACM TOMACS 2005).
+ *
+ * Events far in the future are appended, unsorted, to the top list. When
+ * everything before them has run, they are spread into the buckets of a rung
+ * by time. Buckets are consumed in time order: small ones are sorted into the
+ * bottom list, from which events are removed, and large ones are split into
+ * the buckets of a finer rung below. Inserting and removing the next event
+ * take O(1) amortized time, instead of the O(log n) of the map and heap
+ * schedulers, and only the small bottom list is ever sorted.
+ *
+ * Rungs and buckets are reused, so once the simulation is running the
+ * scheduler does not allocate memory for every event as MapScheduler does.
+ */
+class LadderScheduler : public Scheduler {
+public:
+  static auto GetTypeId() -> TypeId;
+
+  LadderScheduler();
+
+  ~LadderScheduler() override;
+
+  void Insert(const Event& ev) override;
+
+  auto IsEmpty() const -> bool override;
+
+  auto PeekNext() const -> Event override;
+
+  auto RemoveNext() -> Event override;
+
+  void Remove(const Event& ev) override;
+
+private:
+  struct Rung {
+    uint64_t start = 0; ///< Time stamp of the beginning of the first bucket
+    uint64_t width = 1; ///< Time stamps per bucket
+    size_t nBuckets = 0;
+    size_t current = 0; ///< Buckets before this one are empty
+    size_t count = 0;   ///< Events in the buckets
+    std::vector<std::vector<Event>> buckets;
+
+    auto
+    CurrentStart() const -> uint64_t
+    {
+      return start + current * width;
+    }
+  };
+
+  /// Spreads events between minTs and maxTs into a new rung below the others
+  void Spawn(std::vector<Event>& events, uint64_t minTs, uint64_t maxTs);
+
+  /// Moves the next events into the bottom list, which must be empty
+  void RefillBottom();
+
+  /// Inserts into the bottom list, which is sorted from the last event to the next one
+  void InsertBottom(const Event& ev);
+
+  std::vector<Event> m_top;
+  uint64_t m_topStart; ///< Events at or after this time go to the top list
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+
+  std::vector<Rung> m_rungs; ///< Each rung spans the current bucket of the one above
+  size_t m_nRungs;           ///< Rungs in use. The rest are kept for their buckets.
+
+  std::vector<Event> m_bottom;
+  size_t m_size;
+};
+
+/**
+ * Selects the scheduler of the simulator by a short name: map (the default of
+ * ns-3), heap, list, calendar or ladder (LadderScheduler). Other names are
+ * taken as the TypeId of a scheduler. Call it before scheduling any event.
+ */
+void SelectScheduler(const std::string& name);
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_LADDER_SCHEDULER_H
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "producer-fast.hpp"
+
+#include <ns3/log.h>
+#include <ns3/string.h>
+#include <ns3/uinteger.h>
+
+#include <ns3/ndnSIM/helper/ndn-fib-helper.hpp>
+
+NS_LOG_COMPONENT_DEFINE("ndn.ProducerFast");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED(ProducerFast);
+
+auto
+ProducerFast::GetTypeId() -> TypeId
+{
+  // The attributes of Producer, so that either one can be installed with the same helper
+  static TypeId tid =
+    TypeId("ns3::ndn::ProducerFast")
+      .SetGroupName("Ndn")
+      .SetParent<App>()
+      .AddConstructor<ProducerFast>()
+      .AddAttribute("Prefix", "Prefix, for which producer has the data", StringValue("/"),
+                    MakeNameAccessor(&ProducerFast::m_prefix), MakeNameChecker())
+      .AddAttribute("Postfix",
+                    "Postfix that is added to the output data (e.g., for adding "
+                    "producer-uniqueness)",
+                    StringValue("/"), MakeNameAccessor(&ProducerFast::m_postfix),
+                    MakeNameChecker())
+      .AddAttribute("PayloadSize", "Virtual payload size for Content packets", UintegerValue(1024),
+                    MakeUintegerAccessor(&ProducerFast::m_virtualPayloadSize),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("Freshness", "Freshness of data packets, if 0, then unlimited freshness",
+                    TimeValue(Seconds(0)), MakeTimeAccessor(&ProducerFast::m_freshness),
+                    MakeTimeChecker())
+      .AddAttribute("Signature",
+                    "Fake signature, 0 valid signature (default), other values "
+                    "application-specific",
+                    UintegerValue(0), MakeUintegerAccessor(&ProducerFast::m_signature),
+                    MakeUintegerChecker<uint32_t>())
+      .AddAttribute("KeyLocator",
+                    "Name to be used for key locator.  If root, then key locator is not used",
+                    NameValue(), MakeNameAccessor(&ProducerFast::m_keyLocator),
+                    MakeNameChecker());
+
+  return tid;
+}
+
+ProducerFast::ProducerFast()
+  : m_virtualPayloadSize(1024)
+  , m_signature(0)
+{
+}
+
+void
+ProducerFast::StartApplication()
+{
+  App::StartApplication();
+
+  m_template = DataTemplate(m_virtualPayloadSize, m_freshness, m_signature, m_keyLocator);
+  FibHelper::AddRoute(GetNode(), m_prefix, m_face, 0);
+}
+
+void
+ProducerFast::OnInterest(shared_ptr<const Interest> interest)
+{
+  App::OnInterest(interest); // tracing inside
+
+  NS_LOG_FUNCTION(this << interest);
+
+  if (!m_active) {
+    return;
+  }
+
+  auto data = m_template.Make(interest->getName());
+
+  NS_LOG_INFO("node(" << GetNode()->GetId() << ") responding with Data: " << data->getName());
+
+  m_transmittedDatas(data, this, m_face);
+  m_appLink->onReceiveData(*data);
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_PRODUCER_FAST_H
+#define NDN_PRODUCER_FAST_H
+
+#include <ns3/ndnSIM/model/ndn-common.hpp>
+
+#include <ns3/ndnSIM/apps/ndn-app.hpp>
+#include <ns3/nstime.h>
+
+#include "data-template.hpp"
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Drop-in replacement of ns3::ndn::Producer, with the same attributes and the
+ * same Data packets, built from a DataTemplate.
+ */
+class ProducerFast : public App {
+public:
+  static auto GetTypeId() -> TypeId;
+
+  ProducerFast();
+
+  void OnInterest(shared_ptr<const Interest> interest) override;
+
+protected:
+  void StartApplication() override;
+
+private:
+  Name m_prefix;
+  Name m_postfix;
+  uint32_t m_virtualPayloadSize;
+  Time m_freshness;
+
+  uint32_t m_signature;
+  Name m_keyLocator;
+
+  DataTemplate m_template; ///< Built from the attributes when the application starts
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_PRODUCER_FAST_H
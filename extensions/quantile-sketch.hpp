@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_QUANTILE_SKETCH_H
+#define NDN_QUANTILE_SKETCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Streaming quantiles with a bounded relative error.
+ *
+ * Positive values are counted in logarithmic buckets [gamma^(i-1), gamma^i),
+ * with gamma = (1 + accuracy) / (1 - accuracy), so any quantile is returned
+ * within the given relative accuracy using a few hundred counters whatever
+ * the number of samples. Values below MIN_VALUE are counted as zero.
+ */
+class QuantileSketch {
+public:
+  static constexpr double MIN_VALUE = 1e-9;
+
+  explicit QuantileSketch(double accuracy = 0.01)
+    : m_gamma((1 + accuracy) / (1 - accuracy))
+    , m_logGamma(std::log(m_gamma))
+    , m_offset(0)
+    , m_zeros(0)
+    , m_count(0)
+    , m_sum(0)
+    , m_min(std::numeric_limits<double>::max())
+    , m_max(0)
+  {
+  }
+
+  void
+  Add(double value)
+  {
+    m_count++;
+    m_sum += value;
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+
+    if (value < MIN_VALUE) {
+      m_zeros++;
+      return;
+    }
+
+    const int index = static_cast<int>(std::ceil(std::log(value) / m_logGamma));
+    if (m_buckets.empty()) {
+      m_offset = index;
+      m_buckets.push_back(0);
+    }
+    else if (index < m_offset) {
+      m_buckets.insert(m_buckets.begin(), m_offset - index, 0);
+      m_offset = index;
+    }
+    else if (index - m_offset >= static_cast<int>(m_buckets.size())) {
+      m_buckets.resize(index - m_offset + 1, 0);
+    }
+    m_buckets[index - m_offset]++;
+  }
+
+  /// Value below which a fraction q of the samples lie, or zero without samples
+  auto
+  Quantile(double q) const -> double
+  {
+    if (m_count == 0) {
+      return 0;
+    }
+
+    const uint64_t rank = static_cast<uint64_t>(q * (m_count - 1));
+    uint64_t seen = m_zeros;
+    if (rank < seen) {
+      return 0;
+    }
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+      seen += m_buckets[i];
+      if (seen > rank) {
+        // Middle of the bucket (in relative terms), clamped to the samples seen
+        const double value = 2 * std::pow(m_gamma, m_offset + static_cast<int>(i)) / (m_gamma + 1);
+        return std::min(std::max(value, m_min), m_max);
+      }
+    }
+
+    return m_max;
+  }
+
+  auto
+  GetCount() const noexcept -> uint64_t
+  {
+    return m_count;
+  }
+
+  auto
+  GetMean() const noexcept -> double
+  {
+    return m_count > 0 ? m_sum / m_count : 0;
+  }
+
+  auto
+  GetMax() const noexcept -> double
+  {
+    return m_max;
+  }
+
+private:
+  double m_gamma;
+  double m_logGamma;
+  std::vector<uint64_t> m_buckets;
+  int m_offset; // Index of the first bucket
+  uint64_t m_zeros;
+  uint64_t m_count;
+  double m_sum;
+  double m_min;
+  double m_max;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_QUANTILE_SKETCH_H
@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "queue-monitor.hpp"
+
+#include <ns3/fatal-error.h>
+
+namespace ns3 {
+namespace ndn {
+
+QueueMonitor::QueueMonitor(const std::string& fileName, Time interval)
+  : m_interval(interval.GetNanoSeconds())
+  , m_fileName(fileName)
+  , m_closed(false)
+  , m_threshold(0)
+{
+  NS_ABORT_MSG_IF(m_interval <= 0, "Queue bins must have a positive length");
+}
+
+QueueMonitor::~QueueMonitor()
+{
+  Close();
+}
+
+auto
+QueueMonitor::AddQueue(const std::string& name) -> uint32_t
+{
+  const int64_t now = Simulator::Now().GetNanoSeconds();
+
+  m_queues.emplace_back();
+  Queue& queue = m_queues.back();
+  queue.name = name;
+  queue.binEnd = (now / m_interval + 1) * m_interval;
+  queue.lastChange = now;
+  if (m_detail != nullptr) {
+    queue.detailSource = m_detail->DefineSource(name);
+  }
+
+  return m_queues.size() - 1;
+}
+
+void
+QueueMonitor::SetDetail(Ptr<TraceSink> sink, uint32_t threshold)
+{
+  m_detail = sink;
+  m_threshold = threshold;
+
+  for (Queue& queue : m_queues) {
+    queue.detailSource = m_detail->DefineSource(queue.name);
+  }
+}
+
+void
+QueueMonitor::Open()
+{
+  m_file.open(m_fileName);
+  NS_ABORT_MSG_IF(!m_file, "Cannot create " << m_fileName);
+
+  m_file << "Time\tQueue\tMin\tMax\tMean\tLast\n";
+}
+
+void
+QueueMonitor::CloseBins(Queue& queue, int64_t now)
+{
+  if (!m_file.is_open()) {
+    Open();
+  }
+
+  while (now >= queue.binEnd) {
+    const double area =
+      queue.area + static_cast<double>(queue.last) * (queue.binEnd - queue.lastChange);
+    m_file << queue.binEnd / 1e9 << '\t' << queue.name << '\t' << queue.min << '\t' << queue.max
+           << '\t' << area / m_interval << '\t' << queue.last << '\n';
+
+    // The next bin starts with the length the queue had at the end of this one
+    queue.area = 0;
+    queue.lastChange = queue.binEnd;
+    queue.min = queue.last;
+    queue.max = queue.last;
+    queue.binEnd += m_interval;
+  }
+}
+
+void
+QueueMonitor::Close()
+{
+  if (m_closed) {
+    return;
+  }
+
+  if (!m_file.is_open()) {
+    Open();
+  }
+
+  const int64_t now = Simulator::Now().GetNanoSeconds();
+  for (Queue& queue : m_queues) {
+    CloseBins(queue, now);
+  }
+  m_file.close();
+  m_closed = true;
+
+  if (m_detail != nullptr) {
+    m_detail->Close();
+  }
+}
+
+} // namespace ndn
+} // namespace ns3
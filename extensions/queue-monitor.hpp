@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_QUEUE_MONITOR_H
+#define NDN_QUEUE_MONITOR_H
+
+#include "trace-sink.hpp"
+
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+#include <ns3/simple-ref-count.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Summarized queue length traces.
+ *
+ * Instead of a record per change of the queue length (two per packet), writes
+ * the minimum, maximum, time-weighted mean and last length of each queue in
+ * bins of fixed length, as a tab separated file with a header line. Bins are
+ * closed when the queue changes again or the monitor is closed, so no events
+ * are scheduled, and the rows of different queues are not sorted by time.
+ * Bins are aligned to multiples of the interval and times are those of their
+ * ends.
+ *
+ * Optionally, every change is also written to a TraceSink (as the old queue
+ * traces were) while the queue is at or above a threshold, to get the detail
+ * of congestion episodes only.
+ */
+class QueueMonitor : public SimpleRefCount<QueueMonitor> {
+public:
+  /// \param interval Length of the bins
+  explicit QueueMonitor(const std::string& fileName, Time interval = MilliSeconds(10));
+
+  ~QueueMonitor();
+
+  QueueMonitor(const QueueMonitor&) = delete;
+  auto operator=(const QueueMonitor&) -> QueueMonitor& = delete;
+
+  /// Registers a queue and returns the identifier to use with OnChange
+  auto AddQueue(const std::string& name) -> uint32_t;
+
+  /**
+   * Writes the changes of the queues that reach \p threshold packets (old and
+   * new length) to \p sink, which needs two values and trace::HAS_SOURCE. A
+   * zero threshold writes every change.
+   */
+  void SetDetail(Ptr<TraceSink> sink, uint32_t threshold);
+
+  /// Connect to the PacketsInQueue trace of the queue
+  void
+  OnChange(uint32_t queue, uint32_t oldSize, uint32_t newSize)
+  {
+    const int64_t now = Simulator::Now().GetNanoSeconds();
+    Queue& q = m_queues[queue];
+
+    if (now >= q.binEnd) {
+      CloseBins(q, now);
+    }
+    q.area += static_cast<double>(q.last) * (now - q.lastChange);
+    q.lastChange = now;
+    q.last = newSize;
+    q.min = std::min(q.min, newSize);
+    q.max = std::max(q.max, newSize);
+
+    if (m_detail != nullptr && std::max(oldSize, newSize) >= m_threshold) {
+      m_detail->Write(q.detailSource, oldSize, newSize);
+    }
+  }
+
+  /// Writes the bins that are complete by now and closes the file and the detail trace
+  void Close();
+
+private:
+  struct Queue {
+    std::string name;
+    uint32_t detailSource = 0;
+
+    int64_t binEnd = 0;
+    int64_t lastChange = 0;
+    double area = 0; ///< Packets × ns since the beginning of the bin
+    uint32_t last = 0;
+    uint32_t min = 0;
+    uint32_t max = 0;
+  };
+
+  /// The file is created with the first bin, like the trace sinks, so that
+  /// monitors can be set up before forking replications
+  void Open();
+
+  /// Writes the bins of the queue that end before now
+  void CloseBins(Queue& queue, int64_t now);
+
+  const int64_t m_interval; // Nanoseconds
+  const std::string m_fileName;
+  std::ofstream m_file;
+  bool m_closed;
+  std::vector<Queue> m_queues;
+
+  Ptr<TraceSink> m_detail;
+  uint32_t m_threshold;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_QUEUE_MONITOR_H
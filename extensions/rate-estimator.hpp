@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_RATE_ESTIMATOR_H
+#define NDN_RATE_ESTIMATOR_H
+
+#include "congestion-mark.hpp"
+
+#include <ns3/nstime.h>
+#include <ns3/simulator.h>
+
+#include <cmath>
+#include <cstdint>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Transmission rate of a device queue, for the rate marks of the patched
+ * GenericLinkService (see extras/). Copy it next to it, like
+ * congestion-mark.hpp.
+ *
+ * OnDequeue() must be called from the Dequeue trace of the queue. Every
+ * interval the bytes dequeued in it are folded into an exponentially weighted
+ * moving average, and the rate mark fields are encoded once. Idle intervals
+ * are accounted for when the queue is dequeued again or the mark is read, as
+ * a periodic timer would, but without scheduling any event. So reading the
+ * mark is cheap and never stale, whatever the rate of the link.
+ */
+class RateEstimator {
+public:
+  explicit RateEstimator(Time interval = MilliSeconds(10), double gain = 0.25)
+    : m_interval(interval.GetTimeStep())
+    , m_gain(gain)
+    , m_start(Simulator::Now().GetTimeStep())
+    , m_next(m_start + m_interval)
+    , m_bytes(0)
+    , m_rate(0)
+    , m_fields(mark::EncodeRate(0, 0))
+    , m_first(true)
+  {
+  }
+
+  void
+  OnDequeue(uint32_t bytes)
+  {
+    Refresh();
+    m_bytes += bytes;
+  }
+
+  /// Estimated rate, in bytes per second
+  auto
+  GetRate() -> double
+  {
+    Refresh();
+    return m_rate;
+  }
+
+  /// Rate mark with a zero hop count
+  auto
+  GetMark(uint32_t linkId) -> uint64_t
+  {
+    Refresh();
+    return static_cast<uint64_t>(linkId) << 32U | m_fields;
+  }
+
+private:
+  void
+  Refresh()
+  {
+    const int64_t now = Simulator::Now().GetTimeStep();
+    if (now >= m_next) {
+      Update(now);
+    }
+  }
+
+  /// Closes the current interval, and every idle one up to now
+  void
+  Update(int64_t now)
+  {
+    const int64_t intervals = (now - m_start) / m_interval;
+    const int64_t end = m_start + intervals * m_interval;
+    const double sample = m_bytes / TimeStep(end - m_start).GetSeconds();
+
+    if (m_first) {
+      m_rate = sample;
+      m_first = false;
+    }
+    else {
+      // The bytes are spread over all the intervals, so this is the same as
+      // one update per interval with their mean rate
+      m_rate += (1 - std::pow(1 - m_gain, intervals)) * (sample - m_rate);
+    }
+    m_fields = mark::EncodeRate(0, static_cast<uint64_t>(m_rate));
+
+    m_bytes = 0;
+    m_start = end;
+    m_next = end + m_interval;
+  }
+
+  const int64_t m_interval; ///< Time steps
+  const double m_gain;
+
+  int64_t m_start; ///< Beginning of the current interval
+  int64_t m_next;  ///< End of the current interval
+  uint64_t m_bytes;
+
+  double m_rate;
+  uint64_t m_fields; ///< Encoded rate mark, without the link ID
+  bool m_first;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_RATE_ESTIMATOR_H
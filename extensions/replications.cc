@@ -0,0 +1,149 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "replications.hpp"
+#include "trace-sink.hpp"
+
+#include <ns3/fatal-error.h>
+#include <ns3/rng-seed-manager.h>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace ns3 {
+namespace ndn {
+
+auto
+ParseRuns(const std::string& runs) -> std::vector<uint32_t>
+{
+  std::vector<uint32_t> result;
+  std::istringstream list(runs);
+  std::string item;
+
+  while (std::getline(list, item, ',')) {
+    unsigned long first = 0;
+    unsigned long last = 0;
+    char dash = 0;
+    char extra = 0;
+    std::istringstream range(item);
+
+    range >> first;
+    NS_ABORT_MSG_IF(range.fail(), "Invalid run number in " << runs);
+    last = first;
+    if (range >> dash) {
+      NS_ABORT_MSG_IF(dash != '-' || !(range >> last) || range >> extra || last < first,
+                      "Invalid run range " << item);
+    }
+
+    for (unsigned long run = first; run <= last; run++) {
+      result.push_back(run);
+    }
+  }
+  NS_ABORT_MSG_IF(result.empty(), "No runs in " << runs);
+
+  return result;
+}
+
+namespace {
+/// Switches the child process to its run and its directory
+void
+enterRun(uint32_t run)
+{
+  const std::string directory = "run-" + std::to_string(run);
+
+  NS_ABORT_MSG_IF(mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST,
+                  "Cannot create " << directory);
+  NS_ABORT_MSG_IF(chdir(directory.c_str()) != 0, "Cannot enter " << directory);
+  NS_ABORT_MSG_IF(std::freopen("stdout.txt", "w", stdout) == nullptr,
+                  "Cannot redirect the output of run " << run);
+
+  RngSeedManager::SetRun(run);
+}
+} // namespace
+
+void
+ForkReplications(const std::string& runs, unsigned jobs)
+{
+  const std::vector<uint32_t> runList = ParseRuns(runs);
+  // The children would share the file and lack the writer thread of the sink
+  NS_ABORT_MSG_IF(TraceSink::OpenFiles() > 0,
+                  "A trace file was opened before forking the replications");
+  if (jobs == 0) {
+    jobs = std::max(1U, std::thread::hardware_concurrency());
+  }
+
+  // Whatever is buffered would be written again by every child
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+
+  std::map<pid_t, uint32_t> children;
+  size_t next = 0;
+  unsigned failed = 0;
+
+  while (next < runList.size() || !children.empty()) {
+    if (next < runList.size() && children.size() < jobs) {
+      const uint32_t run = runList[next++];
+      const pid_t pid = fork();
+      NS_ABORT_MSG_IF(pid < 0, "Cannot fork run " << run);
+
+      if (pid == 0) {
+        enterRun(run);
+        return;
+      }
+      children[pid] = run;
+      continue;
+    }
+
+    int status = 0;
+    const pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      NS_ABORT_MSG_IF(errno != EINTR, "Lost track of the replications");
+      continue;
+    }
+
+    const auto child = children.find(pid);
+    if (child == children.end()) {
+      continue;
+    }
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      std::cerr << "Run " << child->second << " finished" << std::endl;
+    }
+    else {
+      std::cerr << "Run " << child->second << " failed" << std::endl;
+      failed++;
+    }
+    children.erase(child);
+  }
+
+  std::cerr << runList.size() - failed << " of " << runList.size() << " runs finished" << std::endl;
+  std::exit(failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_REPLICATIONS_H
+#define NDN_REPLICATIONS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/// Parses a list of run numbers and ranges, e.g. "1-5,8". Aborts on malformed lists.
+auto ParseRuns(const std::string& runs) -> std::vector<uint32_t>;
+
+/**
+ * Runs several replications of a scenario that is built only once.
+ *
+ * Call it when the scenario is ready, just before Simulator::Run(). It forks a
+ * process per run number, at most \p jobs at a time (0 for one per core). They
+ * share the memory of the topology, the stacks and the FIBs until they modify
+ * it. Each process switches to its run number and to its own directory (run-N),
+ * where its traces and its standard output go, and returns to run the
+ * simulation. The parent waits for all of them and exits, with an error if any
+ * of them failed, so it never returns.
+ *
+ * Only the objects that draw their random numbers once the simulation runs
+ * (e.g. the ConsumerSrc and link random streams) see the new run number, and
+ * no trace file may be opened before forking. TraceSink and QueueMonitor
+ * create their files lazily for this reason, and it aborts if a TraceSink
+ * has already opened its file.
+ */
+void ForkReplications(const std::string& runs, unsigned jobs = 0);
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_REPLICATIONS_H
@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "route-cache.hpp"
+
+#include <ns3/channel.h>
+#include <ns3/fatal-error.h>
+#include <ns3/log.h>
+#include <ns3/net-device.h>
+#include <ns3/node-list.h>
+
+#include <ns3/ndnSIM/NFD/daemon/fw/forwarder.hpp>
+#include <ns3/ndnSIM/helper/boost-graph-ndn-global-routing-helper.hpp>
+#include <ns3/ndnSIM/helper/ndn-fib-helper.hpp>
+#include <ns3/ndnSIM/model/ndn-global-router.hpp>
+#include <ns3/ndnSIM/model/ndn-l3-protocol.hpp>
+#include <ns3/ndnSIM/model/ndn-net-device-transport.hpp>
+
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+namespace ndn {
+
+NS_LOG_COMPONENT_DEFINE("ndn.RouteCache");
+
+namespace {
+/* File layout: the header, the routes, the offsets of the prefix names (one
+ * more than prefixes, the last one is the end) and the names as URIs. */
+constexpr char MAGIC[8] = {'J', 'Q', 'M', 'F', 'I', 'B', '0', '1'};
+constexpr uint16_t VERSION = 2;
+
+struct Header {
+  char magic[8];
+  uint16_t version;
+  uint16_t reserved;
+  uint32_t nPrefixes;
+  uint64_t key;
+  uint32_t nEntries;
+  uint32_t nameBytes;
+};
+
+static_assert(sizeof(Header) == 32, "Unexpected route cache header size");
+
+auto
+fileSize(const Header& header, size_t entrySize) -> size_t
+{
+  return sizeof(Header) + header.nEntries * entrySize + (header.nPrefixes + 1) * sizeof(uint32_t)
+         + header.nameBytes;
+}
+
+/// Nodes at the other end of the link of a face, or "local" for the faces of the node itself
+auto
+peersOf(const nfd::Face& face) -> std::string
+{
+  const auto* transport = dynamic_cast<const NetDeviceTransport*>(face.getTransport());
+  if (transport == nullptr) {
+    return "local";
+  }
+
+  const Ptr<NetDevice> device = transport->GetNetDevice();
+  const Ptr<Channel> channel = device->GetChannel();
+  if (channel == nullptr) {
+    return "none";
+  }
+
+  std::string peers;
+  for (std::size_t i = 0; i < channel->GetNDevices(); i++) {
+    const Ptr<NetDevice> peer = channel->GetDevice(i);
+    if (peer != device) {
+      peers += ' ' + std::to_string(peer->GetNode()->GetId());
+    }
+  }
+
+  return peers;
+}
+} // namespace
+
+RouteCache::RouteCache(const std::string& topologyFile, const std::string& directory)
+  : m_directory(directory)
+  , m_key(0xCBF29CE484222325ULL)
+{
+  std::ifstream file(topologyFile);
+  NS_ABORT_MSG_IF(!file, "Cannot open topology file " << topologyFile);
+
+  std::ostringstream topology;
+  topology << file.rdbuf();
+  Update(topology.str());
+}
+
+void
+RouteCache::Update(const std::string& text)
+{
+  for (const unsigned char c : text) {
+    m_key = (m_key ^ c) * 0x100000001B3ULL;
+  }
+}
+
+void
+RouteCache::UpdateFaces()
+{
+  // Face IDs depend on the order in which each scenario creates the links and the stacks
+  Update("nodes " + std::to_string(NodeList::GetNNodes()) + '\n');
+  for (uint32_t id = 0; id < NodeList::GetNNodes(); id++) {
+    Ptr<L3Protocol> l3 = NodeList::GetNode(id)->GetObject<L3Protocol>();
+    if (l3 == nullptr) {
+      continue;
+    }
+
+    for (const nfd::Face& face : l3->getForwarder()->getFaceTable()) {
+      Update("face " + std::to_string(id) + ' ' + std::to_string(face.getId()) + ' '
+             + peersOf(face) + '\n');
+    }
+  }
+}
+
+void
+RouteCache::AddOrigins(const std::string& prefix, Ptr<Node> node)
+{
+  m_helper.AddOrigins(prefix, node);
+
+  // Names are identified by their index in the file
+  const Name name(prefix);
+  Update("origin " + name.toUri() + ' ' + std::to_string(node->GetId()) + '\n');
+  for (const std::string& known : m_prefixes) {
+    if (known == name.toUri()) {
+      return;
+    }
+  }
+  m_prefixes.push_back(name.toUri());
+}
+
+auto
+RouteCache::FileName() const -> std::string
+{
+  std::ostringstream name;
+  name << m_directory << '/' << std::hex << std::setfill('0') << std::setw(16) << m_key << ".fib";
+
+  return name.str();
+}
+
+void
+RouteCache::CalculateRoutes()
+{
+  if (m_directory.empty()) {
+    GlobalRoutingHelper::CalculateRoutes();
+    return;
+  }
+
+  UpdateFaces();
+  if (Load()) {
+    NS_LOG_INFO("Routes installed from " << FileName());
+    return;
+  }
+
+  std::vector<Name> prefixes;
+  for (const std::string& prefix : m_prefixes) {
+    prefixes.emplace_back(prefix);
+  }
+
+  const std::vector<Route> routes = Compute();
+  Install(routes, prefixes);
+  Save(routes);
+}
+
+/* A copy of the shortest paths of GlobalRoutingHelper::CalculateRoutes(), which
+ * installs the routes as it finds them. Here they are collected instead, so
+ * that the saved routes are exactly the ones calculated, whether or not the
+ * forwarders have processed them yet. The destinations are visited by node ID
+ * rather than in the order of the hash map of the distances, which changes
+ * from run to run. */
+auto
+RouteCache::Compute() const -> std::vector<Route>
+{
+  boost::NdnGlobalRouterGraph graph;
+  std::vector<Route> routes;
+
+  for (uint32_t id = 0; id < NodeList::GetNNodes(); id++) {
+    Ptr<GlobalRouter> source = NodeList::GetNode(id)->GetObject<GlobalRouter>();
+    if (source == nullptr) {
+      continue;
+    }
+
+    boost::DistancesMap distances;
+    dijkstra_shortest_paths(graph, source,
+                            distance_map(boost::ref(distances))
+                              .distance_inf(boost::WeightInf)
+                              .distance_zero(boost::WeightZero)
+                              .distance_compare(boost::WeightCompare())
+                              .distance_combine(boost::WeightCombine()));
+
+    std::vector<std::pair<uint32_t, boost::DistancesMap::const_iterator>> destinations;
+    for (auto dist = distances.cbegin(); dist != distances.cend(); ++dist) {
+      // Neither the source itself nor unreachable nodes
+      if (dist->first != source && std::get<0>(dist->second) != nullptr) {
+        destinations.emplace_back(dist->first->GetObject<Node>()->GetId(), dist);
+      }
+    }
+    std::sort(destinations.begin(), destinations.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (const auto& destination : destinations) {
+      const auto& dist = *destination.second;
+      for (const auto& prefix : dist.first->GetLocalPrefixes()) {
+        const auto known = std::find(m_prefixes.begin(), m_prefixes.end(), prefix->toUri());
+        NS_ABORT_MSG_IF(known == m_prefixes.end(),
+                        "Origin " << *prefix << " was not added through the RouteCache");
+
+        const auto faceId = std::get<0>(dist.second)->getId();
+        const auto cost = std::get<1>(dist.second);
+        NS_ABORT_MSG_IF(faceId > std::numeric_limits<uint32_t>::max()
+                          || cost > std::numeric_limits<uint32_t>::max(),
+                        "Route to " << *prefix << " does not fit in the route cache");
+        routes.push_back(Route{id, static_cast<uint32_t>(known - m_prefixes.begin()),
+                               static_cast<uint32_t>(faceId), static_cast<uint32_t>(cost)});
+      }
+    }
+  }
+
+  return routes;
+}
+
+void
+RouteCache::Install(const std::vector<Route>& routes, const std::vector<Name>& prefixes)
+{
+  for (const Route& route : routes) {
+    Ptr<Node> node = NodeList::GetNode(route.node);
+    shared_ptr<Face> face = node->GetObject<L3Protocol>()->getFaceById(route.face);
+    FibHelper::AddRoute(node, prefixes[route.prefix], face, route.cost);
+  }
+}
+
+auto
+RouteCache::Load() const -> bool
+{
+  const std::string fileName = FileName();
+  const int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) {
+    NS_ABORT_MSG_IF(errno != ENOENT, "Cannot open route cache " << fileName);
+    return false;
+  }
+
+  struct stat status;
+  NS_ABORT_MSG_IF(fstat(fd, &status) != 0, "Cannot read route cache " << fileName);
+  const size_t size = status.st_size;
+  if (size < sizeof(Header)) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  NS_ABORT_MSG_IF(data == MAP_FAILED, "Cannot map route cache " << fileName);
+
+  const char* base = static_cast<const char*>(data);
+  const auto& header = *reinterpret_cast<const Header*>(base);
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+      || header.key != m_key || header.nPrefixes != m_prefixes.size()
+      || fileSize(header, sizeof(Route)) != size) {
+    // Another version or another hash, recalculate and overwrite it
+    munmap(data, size);
+    return false;
+  }
+
+  const auto* entries = reinterpret_cast<const Route*>(base + sizeof(Header));
+  const auto* offsets = reinterpret_cast<const uint32_t*>(entries + header.nEntries);
+  const char* names = reinterpret_cast<const char*>(offsets + header.nPrefixes + 1);
+
+  std::vector<Name> prefixes;
+  for (uint32_t i = 0; i < header.nPrefixes; i++) {
+    NS_ABORT_MSG_IF(offsets[i] > offsets[i + 1] || offsets[i + 1] > header.nameBytes,
+                    "Corrupt route cache " << fileName);
+    prefixes.emplace_back(std::string(names + offsets[i], offsets[i + 1] - offsets[i]));
+  }
+
+  // Everything is checked before installing anything, so that a bad file can
+  // still be replaced by calculating the routes
+  std::vector<bool> reached(header.nPrefixes, false);
+  for (uint32_t i = 0; i < header.nEntries; i++) {
+    const Route& entry = entries[i];
+    NS_ABORT_MSG_IF(entry.node >= NodeList::GetNNodes() || entry.prefix >= prefixes.size(),
+                    "Corrupt route cache " << fileName);
+
+    Ptr<L3Protocol> l3 = NodeList::GetNode(entry.node)->GetObject<L3Protocol>();
+    NS_ABORT_MSG_IF(l3 == nullptr, "Route cache " << fileName << " has routes for node "
+                                                  << entry.node << ", which has no stack");
+    NS_ABORT_MSG_IF(l3->getFaceById(entry.face) == nullptr,
+                    "Route cache " << fileName << " uses face " << entry.face << " of node "
+                                   << entry.node << ", which does not exist. Remove it.");
+    reached[entry.prefix] = true;
+  }
+
+  const auto missing = std::find(reached.begin(), reached.end(), false);
+  if (missing != reached.end()) {
+    NS_LOG_WARN("Route cache " << fileName << " has no routes to "
+                               << prefixes[missing - reached.begin()] << ", recalculating them");
+    munmap(data, size);
+    return false;
+  }
+
+  Install(std::vector<Route>(entries, entries + header.nEntries), prefixes);
+
+  munmap(data, size);
+  return true;
+}
+
+void
+RouteCache::Save(const std::vector<Route>& routes) const
+{
+  // Such a file would never be loaded
+  std::vector<bool> reached(m_prefixes.size(), false);
+  for (const Route& route : routes) {
+    reached[route.prefix] = true;
+  }
+  const auto missing = std::find(reached.begin(), reached.end(), false);
+  if (missing != reached.end()) {
+    NS_LOG_WARN("No routes to " << m_prefixes[missing - reached.begin()]
+                                << ", the routes are not cached");
+    return;
+  }
+
+  std::vector<uint32_t> offsets{0};
+  std::string names;
+  for (const std::string& prefix : m_prefixes) {
+    names += prefix;
+    offsets.push_back(names.size());
+  }
+
+  Header header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.nPrefixes = m_prefixes.size();
+  header.key = m_key;
+  header.nEntries = routes.size();
+  header.nameBytes = names.size();
+
+  NS_ABORT_MSG_IF(mkdir(m_directory.c_str(), 0777) != 0 && errno != EEXIST,
+                  "Cannot create " << m_directory);
+
+  // Several runs may be saving the same routes, so the file appears whole or not at all
+  const std::string fileName = FileName();
+  const std::string tmpName = fileName + '.' + std::to_string(getpid());
+  std::FILE* file = std::fopen(tmpName.c_str(), "wb");
+  NS_ABORT_MSG_IF(file == nullptr, "Cannot create " << tmpName);
+
+  const bool written =
+    std::fwrite(&header, sizeof(header), 1, file) == 1
+    && std::fwrite(routes.data(), sizeof(Route), routes.size(), file) == routes.size()
+    && std::fwrite(offsets.data(), sizeof(uint32_t), offsets.size(), file) == offsets.size()
+    && std::fwrite(names.data(), 1, names.size(), file) == names.size();
+  NS_ABORT_MSG_IF(std::fclose(file) != 0 || !written, "Cannot write " << tmpName);
+  NS_ABORT_MSG_IF(std::rename(tmpName.c_str(), fileName.c_str()) != 0,
+                  "Cannot create " << fileName);
+
+  NS_LOG_INFO("Saved " << routes.size() << " routes to " << fileName);
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_ROUTE_CACHE_H
+#define NDN_ROUTE_CACHE_H
+
+#include <ns3/ndnSIM/helper/ndn-global-routing-helper.hpp>
+#include <ns3/node.h>
+#include <ns3/ptr.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Cache of the routes computed by GlobalRoutingHelper.
+ *
+ * Use it instead of GlobalRoutingHelper::AddOrigins() and CalculateRoutes().
+ * The routes depend only on the topology file, the origins and the faces of
+ * every node, so they are stored in a file named after a hash of them (each
+ * face by its ID and the nodes at the other end of its link), in a directory
+ * shared by all the runs of a sweep. The first run computes the routes with
+ * the shortest paths of GlobalRoutingHelper::CalculateRoutes(), installs them
+ * and saves them. Later runs map the file and install the same routes with
+ * FibHelper, without the shortest paths. A file without routes to some origin
+ * is not trusted: the routes are calculated again and the file replaced.
+ *
+ * The file is written to a temporary name and renamed, so concurrent runs (or
+ * forked replications) may save the same routes. With an empty directory the
+ * cache is disabled and GlobalRoutingHelper calculates the routes.
+ * benchmarks/route-cache checks that both ways give the same FIBs.
+ */
+class RouteCache {
+public:
+  /// Reads the topology file to hash it. Aborts if it cannot be read.
+  RouteCache(const std::string& topologyFile, const std::string& directory);
+
+  RouteCache(const RouteCache&) = delete;
+  auto operator=(const RouteCache&) -> RouteCache& = delete;
+
+  /// Same as GlobalRoutingHelper::AddOrigins()
+  void AddOrigins(const std::string& prefix, Ptr<Node> node);
+
+  /// Installs the cached routes, or calculates them and saves them if they are not cached
+  void CalculateRoutes();
+
+private:
+  /// Route to an origin, as stored in the file
+  struct Route {
+    uint32_t node;
+    uint32_t prefix; ///< Index in m_prefixes
+    uint32_t face;
+    uint32_t cost;
+  };
+  static_assert(sizeof(Route) == 16, "Unexpected route cache entry size");
+
+  /// Adds text to the hash of the routes (FNV-1a)
+  void Update(const std::string& text);
+
+  /// Adds the faces of every node, and where they lead, to the hash
+  void UpdateFaces();
+
+  auto FileName() const -> std::string;
+
+  /// The routes GlobalRoutingHelper::CalculateRoutes() installs
+  auto Compute() const -> std::vector<Route>;
+
+  static void Install(const std::vector<Route>& routes, const std::vector<Name>& prefixes);
+
+  auto Load() const -> bool;
+
+  void Save(const std::vector<Route>& routes) const;
+
+  GlobalRoutingHelper m_helper;
+  std::string m_directory;
+  uint64_t m_key;
+  std::vector<std::string> m_prefixes;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_ROUTE_CACHE_H
@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_ROUTER_TABLE_H
+#define NDN_ROUTER_TABLE_H
+
+#include <ns3/nstime.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Per-router state indexed by link ID.
+ *
+ * A path only crosses a handful of routers, so the IDs are kept in a small
+ * contiguous array that is scanned linearly, which is faster than a tree or a
+ * hash for so few entries. Routers that have not been heard of for a while
+ * (e.g. after a route change) are periodically removed: the table is swept
+ * once every maxAge, so an entry is removed between maxAge and 2 × maxAge
+ * after its router was last heard of. ForEach() skips them as soon as they are
+ * older than maxAge.
+ */
+template <typename T>
+class RouterTable {
+public:
+  explicit RouterTable(Time maxAge = Seconds(5))
+    : m_maxAge(maxAge)
+    , m_lastExpiration(Seconds(0))
+  {
+  }
+
+  /// Also applies to the next sweep, which is due maxAge after the last one
+  void
+  SetMaxAge(Time maxAge)
+  {
+    m_maxAge = maxAge;
+  }
+
+  auto
+  GetMaxAge() const -> Time
+  {
+    return m_maxAge;
+  }
+
+  /// Returns the state of a router, creating it if needed, and refreshes its age
+  auto
+  Get(uint32_t routerId, Time now) -> T&
+  {
+    if (now - m_lastExpiration >= m_maxAge) {
+      Expire(now);
+    }
+
+    for (size_t i = 0; i < m_ids.size(); i++) {
+      if (m_ids[i] == routerId) {
+        m_entries[i].lastSeen = now;
+        return m_entries[i].value;
+      }
+    }
+
+    m_ids.push_back(routerId);
+    m_entries.push_back(Entry{now, T()});
+
+    return m_entries.back().value;
+  }
+
+  /// Calls f with the state of every router heard of in the last maxAge
+  template <typename F>
+  void
+  ForEach(Time now, F f)
+  {
+    for (Entry& entry : m_entries) {
+      if (now - entry.lastSeen <= m_maxAge) {
+        f(entry.value);
+      }
+    }
+  }
+
+  auto
+  Size() const noexcept -> size_t
+  {
+    return m_ids.size();
+  }
+
+private:
+  void
+  Expire(Time now)
+  {
+    size_t i = 0;
+    while (i < m_ids.size()) {
+      if (now - m_entries[i].lastSeen > m_maxAge) {
+        m_ids[i] = m_ids.back();
+        m_entries[i] = std::move(m_entries.back());
+        m_ids.pop_back();
+        m_entries.pop_back();
+      }
+      else {
+        i++;
+      }
+    }
+
+    m_lastExpiration = now;
+  }
+
+  struct Entry {
+    Time lastSeen;
+    T value;
+  };
+
+  // IDs are kept apart from the state so that the search touches as little memory as possible
+  std::vector<uint32_t> m_ids;
+  std::vector<Entry> m_entries;
+
+  Time m_maxAge;
+  Time m_lastExpiration;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_ROUTER_TABLE_H
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "run-profile.hpp"
+
+#include <ns3/fatal-error.h>
+#include <ns3/simulator.h>
+
+#include <sys/resource.h>
+
+#include <fstream>
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+auto
+seconds(std::chrono::steady_clock::duration duration) -> double
+{
+  return std::chrono::duration<double>(duration).count();
+}
+} // namespace
+
+RunProfile::RunProfile()
+  : m_start(Clock::now())
+  , m_runStart(m_start)
+  , m_runEnd(m_start)
+  , m_events(0)
+  , m_simulatedSeconds(0)
+{
+}
+
+void
+RunProfile::StartRun()
+{
+  m_runStart = Clock::now();
+  m_events = Simulator::GetEventCount();
+}
+
+void
+RunProfile::EndRun()
+{
+  m_runEnd = Clock::now();
+  m_events = Simulator::GetEventCount() - m_events;
+  m_simulatedSeconds = Simulator::Now().GetSeconds();
+}
+
+void
+RunProfile::Write(const std::string& fileName) const
+{
+  std::ofstream file(fileName);
+  NS_ABORT_MSG_IF(!file, "Cannot create " << fileName);
+
+  // Linux reports the peak resident set size in kilobytes
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  const double run = seconds(m_runEnd - m_runStart);
+  file << "{\"setup_seconds\": " << seconds(m_runStart - m_start) << ", \"run_seconds\": " << run
+       << ", \"events\": " << m_events << ", \"simulated_seconds\": " << m_simulatedSeconds
+       << ", \"events_per_second\": " << (run > 0 ? m_events / run : 0)
+       << ", \"simulated_per_wall_second\": " << (run > 0 ? m_simulatedSeconds / run : 0)
+       << ", \"peak_rss_kb\": " << usage.ru_maxrss << "}\n";
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,60 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_RUN_PROFILE_H
+#define NDN_RUN_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Wall clock profile of a scenario run: time spent building the scenario and
+ * running the simulation, number of events, simulated time and peak memory.
+ *
+ * Create it at the very beginning of main() and call StartRun() and EndRun()
+ * around Simulator::Run().
+ */
+class RunProfile {
+public:
+  RunProfile();
+
+  void StartRun();
+
+  void EndRun();
+
+  /// Writes the profile as a single JSON object. Aborts if the file cannot be written.
+  void Write(const std::string& fileName) const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  Clock::time_point m_start;
+  Clock::time_point m_runStart;
+  Clock::time_point m_runEnd;
+  uint64_t m_events;
+  double m_simulatedSeconds;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_RUN_PROFILE_H
@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_SOJOURN_ESTIMATOR_H
+#define NDN_SOJOURN_ESTIMATOR_H
+
+#include <ns3/nstime.h>
+#include <ns3/simulator.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Time packets spend in a FIFO device queue. Used by the patched
+ * GenericLinkService (see extras/) instead of DelayJitterEstimation, so it has
+ * to be copied next to it.
+ *
+ * The enqueue times are kept in a ring that mirrors the queue: OnEnqueue() and
+ * OnDequeue() must be called from its Enqueue and Dequeue traces, which ns-3
+ * fires in FIFO order (removed packets are dequeued too). Nothing is attached
+ * to the packets, and the ring only allocates when the queue grows beyond any
+ * previous length.
+ */
+class SojournEstimator {
+public:
+  explicit SojournEstimator(size_t capacity = 64)
+    : m_times(RoundUp(capacity))
+    , m_head(0)
+    , m_size(0)
+    , m_last(0)
+    , m_min(std::numeric_limits<int64_t>::max())
+    , m_smoothed(0)
+    , m_samples(0)
+  {
+  }
+
+  void
+  OnEnqueue()
+  {
+    if (m_size == m_times.size()) {
+      Grow();
+    }
+    m_times[(m_head + m_size) & (m_times.size() - 1)] = Simulator::Now().GetTimeStep();
+    m_size++;
+  }
+
+  /// Dequeues without a matching enqueue (the queue was not empty when traced) are ignored
+  void
+  OnDequeue()
+  {
+    if (m_size == 0) {
+      return;
+    }
+
+    m_last = Simulator::Now().GetTimeStep() - m_times[m_head];
+    m_head = (m_head + 1) & (m_times.size() - 1);
+    m_size--;
+
+    if (m_last < m_min) {
+      m_min = m_last;
+    }
+    // Same gain as the TCP smoothed RTT
+    m_smoothed = m_samples == 0 ? m_last : m_smoothed + (m_last - m_smoothed) / 8;
+    m_samples++;
+  }
+
+  /// Sojourn time of the last dequeued packet
+  auto
+  GetLastDelay() const -> Time
+  {
+    return TimeStep(m_last);
+  }
+
+  /// Smallest sojourn time seen. Zero if no packet has been dequeued yet.
+  auto
+  GetMinDelay() const -> Time
+  {
+    return TimeStep(m_samples == 0 ? 0 : m_min);
+  }
+
+  /// Exponentially weighted moving average of the sojourn time, with gain 1/8
+  auto
+  GetSmoothedDelay() const -> Time
+  {
+    return TimeStep(m_smoothed);
+  }
+
+  /// Packets in the queue
+  auto
+  GetSize() const -> size_t
+  {
+    return m_size;
+  }
+
+  auto
+  GetSamples() const -> uint64_t
+  {
+    return m_samples;
+  }
+
+private:
+  static auto
+  RoundUp(size_t capacity) -> size_t
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1U;
+    }
+
+    return size;
+  }
+
+  void
+  Grow()
+  {
+    std::vector<int64_t> times(m_times.size() * 2);
+    for (size_t i = 0; i < m_size; i++) {
+      times[i] = m_times[(m_head + i) & (m_times.size() - 1)];
+    }
+    m_times.swap(times);
+    m_head = 0;
+  }
+
+  std::vector<int64_t> m_times; ///< Enqueue times (time steps). Its size is a power of 2.
+  size_t m_head;
+  size_t m_size;
+
+  int64_t m_last;
+  int64_t m_min;
+  int64_t m_smoothed;
+  uint64_t m_samples;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_SOJOURN_ESTIMATOR_H
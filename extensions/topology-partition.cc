@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "topology-partition.hpp"
+
+#include <ns3/fatal-error.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+constexpr size_t NONE = std::numeric_limits<size_t>::max();
+} // namespace
+
+TopologyPartition::TopologyPartition(const std::string& topologyFile, uint32_t nParts)
+{
+  std::ifstream file(topologyFile);
+  NS_ABORT_MSG_IF(!file, "Cannot open topology file " << topologyFile);
+  NS_ABORT_MSG_IF(nParts == 0, "The topology must be split in one part at least");
+
+  // Same sections as AnnotatedTopologyReader: nodes after "router", links after "link"
+  enum { PREAMBLE, NODES, LINKS } section = PREAMBLE;
+  std::vector<std::pair<std::string, std::string>> links;
+
+  std::string line;
+  while (std::getline(file, line)) {
+    m_lines.push_back(line);
+
+    std::istringstream fields(line);
+    std::string first, second;
+    if (!(fields >> first) || first[0] == '#') {
+      continue;
+    }
+    if (first == "router") {
+      section = NODES;
+      continue;
+    }
+    if (first == "link") {
+      section = LINKS;
+      continue;
+    }
+
+    if (section == NODES) {
+      NS_ABORT_MSG_IF(m_index.count(first) != 0, "Node " << first << " defined twice");
+      m_index[first] = m_names.size();
+      m_names.push_back(first);
+      m_nodeLines.push_back(m_lines.size() - 1);
+    }
+    else if (section == LINKS && fields >> second) {
+      links.emplace_back(first, second);
+    }
+  }
+
+  m_neighbours.resize(m_names.size());
+  for (const auto& link : links) {
+    const size_t from = FindNode(link.first);
+    const size_t to = FindNode(link.second);
+    m_neighbours[from].push_back(to);
+    m_neighbours[to].push_back(from);
+  }
+
+  // Order the routers breadth first, starting each connected group of routers
+  // from the one with fewer router neighbours (an end of the chain)
+  auto isRouter = [this](size_t node) { return m_neighbours[node].size() > 1; };
+  auto routerDegree = [this, &isRouter](size_t node) {
+    return std::count_if(m_neighbours[node].begin(), m_neighbours[node].end(), isRouter);
+  };
+
+  std::vector<size_t> routers;
+  std::vector<bool> visited(m_names.size(), false);
+  while (true) {
+    size_t start = NONE;
+    for (size_t node = 0; node < m_names.size(); node++) {
+      if (isRouter(node) && !visited[node]
+          && (start == NONE || routerDegree(node) < routerDegree(start))) {
+        start = node;
+      }
+    }
+    if (start == NONE) {
+      break;
+    }
+
+    std::deque<size_t> pending{start};
+    visited[start] = true;
+    while (!pending.empty()) {
+      const size_t node = pending.front();
+      pending.pop_front();
+      routers.push_back(node);
+      for (size_t neighbour : m_neighbours[node]) {
+        if (isRouter(neighbour) && !visited[neighbour]) {
+          visited[neighbour] = true;
+          pending.push_back(neighbour);
+        }
+      }
+    }
+  }
+
+  m_parts.assign(m_names.size(), 0);
+  for (size_t i = 0; i < routers.size(); i++) {
+    m_parts[routers[i]] = i * nParts / routers.size();
+  }
+  for (size_t node = 0; node < m_names.size(); node++) {
+    if (!isRouter(node) && !m_neighbours[node].empty()) {
+      m_parts[node] = m_parts[m_neighbours[node].front()];
+    }
+  }
+}
+
+auto
+TopologyPartition::FindNode(const std::string& name) const -> size_t
+{
+  const auto node = m_index.find(name);
+  NS_ABORT_MSG_IF(node == m_index.end(), "Unknown node " << name);
+
+  return node->second;
+}
+
+auto
+TopologyPartition::GetPart(const std::string& node) const -> uint32_t
+{
+  return m_parts[FindNode(node)];
+}
+
+void
+TopologyPartition::Write(const std::string& fileName) const
+{
+  std::vector<std::string> lines(m_lines);
+  for (size_t node = 0; node < m_names.size(); node++) {
+    std::istringstream fields(lines[m_nodeLines[node]]);
+    std::string name, city = "NA", latitude = "0", longitude = "0";
+    fields >> name >> city >> latitude >> longitude;
+
+    std::ostringstream line;
+    line << name << '\t' << city << '\t' << latitude << '\t' << longitude << '\t'
+         << m_parts[node];
+    lines[m_nodeLines[node]] = line.str();
+  }
+
+  std::ofstream file(fileName);
+  NS_ABORT_MSG_IF(!file, "Cannot create " << fileName);
+  for (const auto& line : lines) {
+    file << line << '\n';
+  }
+}
+
+auto
+TopologyPartition::GetNextHops(const std::string& destination) const
+  -> std::vector<std::pair<std::string, std::string>>
+{
+  // Breadth first search from the destination: the parent of each node in the
+  // search tree is its next hop
+  std::vector<size_t> nextHop(m_names.size(), NONE);
+  const size_t start = FindNode(destination);
+  nextHop[start] = start;
+
+  std::vector<std::pair<std::string, std::string>> routes;
+  std::deque<size_t> pending{start};
+  while (!pending.empty()) {
+    const size_t node = pending.front();
+    pending.pop_front();
+    for (size_t neighbour : m_neighbours[node]) {
+      if (nextHop[neighbour] == NONE) {
+        nextHop[neighbour] = node;
+        routes.emplace_back(m_names[neighbour], m_names[node]);
+        pending.push_back(neighbour);
+      }
+    }
+  }
+
+  return routes;
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_TOPOLOGY_PARTITION_H
+#define NDN_TOPOLOGY_PARTITION_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Splits the nodes of an annotated topology file among MPI ranks.
+ *
+ * Nodes with more than one link (the routers) are walked breadth first from
+ * one end of the network and split into contiguous blocks of the same size, so
+ * a chain of routers is cut into segments. Every other node goes with the
+ * router it hangs from, so only router to router links cross ranks.
+ *
+ * It does not depend on ns-3: every rank computes the same partition and
+ * writes a copy of the topology with the system ID column filled in, which is
+ * then read with AnnotatedTopologyReader.
+ */
+class TopologyPartition {
+public:
+  /// Reads the topology file. Aborts if it cannot be read.
+  TopologyPartition(const std::string& topologyFile, uint32_t nParts);
+
+  /// Part (system ID) of a node
+  auto GetPart(const std::string& node) const -> uint32_t;
+
+  /// Writes the topology file with the system ID of every node set to its part
+  void Write(const std::string& fileName) const;
+
+  /**
+   * Next hop of every node on a shortest path (in hops) towards destination.
+   * Used to install routes when the global routing helper cannot be used
+   * because the stack is not installed on the nodes of the other ranks.
+   */
+  auto GetNextHops(const std::string& destination) const
+    -> std::vector<std::pair<std::string, std::string>>;
+
+private:
+  auto FindNode(const std::string& name) const -> size_t;
+
+  std::vector<std::string> m_lines;
+  std::vector<std::string> m_names;
+  std::vector<size_t> m_nodeLines; // Line of the file that defines each node
+  std::unordered_map<std::string, size_t> m_index;
+  std::vector<std::vector<size_t>> m_neighbours;
+  std::vector<uint32_t> m_parts;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_TOPOLOGY_PARTITION_H
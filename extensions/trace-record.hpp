@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_TRACE_RECORD_H
+#define NDN_TRACE_RECORD_H
+
+#include <cstdint>
+
+/* On-disk layout of the binary traces written by TraceSink. This header does
+ * not depend on ns-3 so that offline tools (trace-to-tsv) can use it. */
+
+namespace ns3 {
+namespace ndn {
+namespace trace {
+
+constexpr char MAGIC[8] = {'J', 'Q', 'M', 'T', 'R', 'C', '0', '1'};
+constexpr uint16_t VERSION = 1;
+
+// Header flags
+constexpr uint8_t HAS_SOURCE = 0x01; // Print the source (node name or id) column
+constexpr uint8_t INTEGRAL = 0x02;   // Values are integer quantities
+
+// Record flags
+constexpr uint32_t SAMPLE = 0;
+constexpr uint32_t NAME = 1; // Defines the name of a source
+
+struct FileHeader {
+  char magic[8];
+  uint16_t version;
+  uint8_t nValues; // Number of value columns (1 or 2)
+  uint8_t flags;
+  uint32_t reserved;
+};
+
+/* A NAME record stores the length of the name in the time field. The name
+ * itself follows, padded with zeros to a multiple of sizeof(Record). */
+struct Record {
+  int64_t time; // Nanoseconds
+  uint32_t source;
+  uint32_t flags;
+  double values[2];
+};
+
+static_assert(sizeof(FileHeader) == 16, "Unexpected trace header size");
+static_assert(sizeof(Record) == 32, "Unexpected trace record size");
+
+} // namespace trace
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_TRACE_RECORD_H
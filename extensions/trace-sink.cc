@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#include "trace-sink.hpp"
+
+#include <ns3/fatal-error.h>
+#include <ns3/log.h>
+
+#include <algorithm>
+#include <cstring>
+
+NS_LOG_COMPONENT_DEFINE("ndn.TraceSink");
+
+namespace ns3 {
+namespace ndn {
+
+namespace {
+// Buffers owned by a sink, including the one being filled. When all of them
+// are waiting to be written the simulation blocks until the disk catches up.
+constexpr size_t MAX_BUFFERS = 4;
+} // namespace
+
+unsigned TraceSink::s_openFiles = 0;
+
+TraceSink::TraceSink(const std::string& fileName, uint8_t nValues, uint8_t flags,
+                     size_t bufferRecords)
+  : m_fileName(fileName)
+  , m_header{}
+  , m_file(nullptr)
+  , m_bufferRecords(std::max<size_t>(bufferRecords, 1))
+  , m_buffer(new trace::Record[m_bufferRecords])
+  , m_used(0)
+  , m_nextSource(0)
+  , m_closing(false)
+{
+  NS_ABORT_MSG_IF(nValues < 1 || nValues > 2, "Traces hold one or two values per sample");
+
+  std::memcpy(m_header.magic, trace::MAGIC, sizeof(m_header.magic));
+  m_header.version = trace::VERSION;
+  m_header.nValues = nValues;
+  m_header.flags = flags;
+}
+
+TraceSink::~TraceSink()
+{
+  Close();
+}
+
+auto
+TraceSink::DefineSource(const std::string& name) -> uint32_t
+{
+  const size_t nRecords = 1 + (name.size() + sizeof(trace::Record) - 1) / sizeof(trace::Record);
+  const uint32_t source = m_nextSource++;
+  trace::Record* record;
+
+  // Sources are defined while the scenario is built, which may be before
+  // forking the replications (see ForkReplications), so their names are kept
+  // apart until the file is opened instead of opening it to flush them.
+  if (m_file == nullptr) {
+    m_names.resize(m_names.size() + nRecords);
+    record = &m_names[m_names.size() - nRecords];
+  }
+  else {
+    NS_ABORT_MSG_IF(nRecords > m_bufferRecords, "Source name too long for the trace buffers");
+    if (m_used + nRecords > m_bufferRecords) {
+      Submit();
+    }
+    record = &m_buffer[m_used];
+    m_used += nRecords;
+  }
+
+  std::memset(record, 0, nRecords * sizeof(trace::Record));
+  record->time = name.size();
+  record->source = source;
+  record->flags = trace::NAME;
+  std::memcpy(record + 1, name.data(), name.size());
+
+  return source;
+}
+
+auto
+TraceSink::OpenFiles() -> unsigned
+{
+  return s_openFiles;
+}
+
+void
+TraceSink::Open()
+{
+  m_file = std::fopen(m_fileName.c_str(), "wb");
+  NS_ABORT_MSG_IF(m_file == nullptr, "Cannot open trace file " << m_fileName);
+  std::fwrite(&m_header, sizeof(m_header), 1, m_file);
+  // Before any sample, which are all still in the buffers
+  std::fwrite(m_names.data(), sizeof(trace::Record), m_names.size(), m_file);
+  m_names.clear();
+  m_names.shrink_to_fit();
+  s_openFiles++;
+
+  m_writer = std::thread(&TraceSink::WriterLoop, this);
+}
+
+void
+TraceSink::Submit()
+{
+  if (m_file == nullptr && !m_closing) {
+    Open();
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  if (m_closing) {
+    m_used = 0;
+    return;
+  }
+
+  if (m_used > 0) {
+    m_pending.emplace_back(std::move(m_buffer), m_used);
+    m_cond.notify_all();
+
+    if (m_free.empty() && m_pending.size() + 1 >= MAX_BUFFERS) {
+      NS_LOG_DEBUG("Waiting for the trace writer");
+      m_cond.wait(lock, [this] { return !m_free.empty(); });
+    }
+
+    if (m_free.empty()) {
+      m_buffer.reset(new trace::Record[m_bufferRecords]);
+    }
+    else {
+      m_buffer = std::move(m_free.back());
+      m_free.pop_back();
+    }
+  }
+
+  m_used = 0;
+}
+
+void
+TraceSink::WriterLoop()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  for (;;) {
+    m_cond.wait(lock, [this] { return m_closing || !m_pending.empty(); });
+    if (m_pending.empty()) {
+      return;
+    }
+
+    auto job = std::move(m_pending.front());
+    m_pending.pop_front();
+
+    lock.unlock();
+    std::fwrite(job.first.get(), sizeof(trace::Record), job.second, m_file);
+    lock.lock();
+
+    m_free.push_back(std::move(job.first));
+    m_cond.notify_all();
+  }
+}
+
+void
+TraceSink::Close()
+{
+  if (m_closing) {
+    return;
+  }
+
+  // The file is created even if nothing was written to it
+  if (m_file == nullptr) {
+    Open();
+  }
+
+  Submit();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closing = true;
+  }
+  m_cond.notify_all();
+  m_writer.join();
+
+  std::fclose(m_file);
+  m_file = nullptr;
+  s_openFiles--;
+}
+
+} // namespace ndn
+} // namespace ns3
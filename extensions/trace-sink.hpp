@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ **/
+
+#ifndef NDN_TRACE_SINK_H
+#define NDN_TRACE_SINK_H
+
+#include "trace-record.hpp"
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/simulator.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * Binary trace file with fixed-width records.
+ *
+ * Records are appended to an in-memory buffer. Full buffers are handed to a
+ * background thread that writes them to disk, so recording a sample costs just
+ * a few stores. Use the trace-to-tsv tool to get back the tab separated format.
+ *
+ * The file is only created, and the thread started, when the first buffer is
+ * written or the sink is closed. So sinks can be set up before forking the
+ * replications of a scenario (see ForkReplications()).
+ */
+class TraceSink : public SimpleRefCount<TraceSink> {
+public:
+  /**
+   * \param fileName Output file
+   * \param nValues Number of values per sample (1 or 2)
+   * \param flags Combination of trace::HAS_SOURCE and trace::INTEGRAL
+   * \param bufferRecords Size, in records, of each of the in-memory buffers
+   */
+  TraceSink(const std::string& fileName, uint8_t nValues, uint8_t flags,
+            size_t bufferRecords = 1U << 16);
+
+  ~TraceSink();
+
+  TraceSink(const TraceSink&) = delete;
+  auto operator=(const TraceSink&) -> TraceSink& = delete;
+
+  /// Registers a source name and returns the identifier to use with Write
+  auto DefineSource(const std::string& name) -> uint32_t;
+
+  void
+  Write(uint32_t source, double first, double second = 0.0)
+  {
+    if (m_used == m_bufferRecords) {
+      Submit();
+    }
+
+    trace::Record& record = m_buffer[m_used++];
+    record.time = Simulator::Now().GetNanoSeconds();
+    record.source = source;
+    record.flags = trace::SAMPLE;
+    record.values[0] = first;
+    record.values[1] = second;
+  }
+
+  /// Writes all pending records and closes the file. Further writes are lost.
+  void Close();
+
+  /// Number of sinks whose file is open, and so have a writer thread
+  static auto OpenFiles() -> unsigned;
+
+private:
+  using Buffer = std::unique_ptr<trace::Record[]>;
+
+  void Open();
+  void Submit();
+  void WriterLoop();
+
+  const std::string m_fileName;
+  trace::FileHeader m_header;
+  std::FILE* m_file;
+  const size_t m_bufferRecords;
+  Buffer m_buffer;
+  size_t m_used;
+  uint32_t m_nextSource;
+  std::vector<trace::Record> m_names; ///< Sources defined before opening the file
+
+  // Shared with the writer thread
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  std::deque<std::pair<Buffer, size_t>> m_pending;
+  std::vector<Buffer> m_free;
+  bool m_closing;
+  std::thread m_writer;
+
+  static unsigned s_openFiles;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_TRACE_SINK_H
@@ -1,102 +1,257 @@
-#!/usr/bin/env python
+#!/usr/bin/env python3
 # -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
 
-from subprocess import call
-from sys import argv
+"""Parameter sweep and replication runner.
+
+Expands a parameter grid times a set of RNG runs into independent jobs and
+executes them in parallel. Every job runs inside its own directory, so the
+traces written by the scenarios (queue-bins.dat, throughput.dat...) never collide.
+A job that finished successfully leaves a 'status' file behind and is skipped
+when the sweep is run again, so interrupted sweeps can be resumed.
+
+Example:
+
+    ./run.py linear-simple -p nComms=2,4,8 -p ns3::ndn::ConsumerSrc::Beta=0.5,0.7 \\
+        --runs 1-10 -o results
+"""
+
+import argparse
+import concurrent.futures
+import hashlib
+import itertools
 import os
+import re
 import subprocess
-import workerpool
-import multiprocessing
-import argparse
+import sys
+import threading
+import time
+
+TOP = os.path.dirname(os.path.abspath(__file__))
+BUILD = os.path.join(TOP, 'build')
 
 ######################################################################
 ######################################################################
 ######################################################################
 
-parser = argparse.ArgumentParser(description='Simulation runner')
+def parse_param(text):
+    "Parses NAME=V1,V2,... into (NAME, [V1, V2, ...])"
+    name, sep, values = text.partition('=')
+    if not sep or not name or not values:
+        raise argparse.ArgumentTypeError("expected NAME=VALUE[,VALUE...], got '%s'" % text)
+    return name, values.split(',')
+
+def parse_runs(text):
+    "Parses a list of RNG runs such as 1-10 or 1,4,7"
+    runs = []
+    for item in text.split(','):
+        first, sep, last = item.partition('-')
+        try:
+            if sep:
+                runs.extend(range(int(first), int(last) + 1))
+            else:
+                runs.append(int(first))
+        except ValueError:
+            raise argparse.ArgumentTypeError("invalid run list '%s'" % text)
+    return runs
+
+def available_scenarios():
+    sources = os.listdir(os.path.join(TOP, 'scenarios'))
+    return sorted(os.path.splitext(s)[0] for s in sources if s.endswith(('.cc', '.cpp')))
+
+parser = argparse.ArgumentParser(description='Simulation sweep runner',
+                                 formatter_class=argparse.RawDescriptionHelpFormatter,
+                                 epilog=__doc__)
 parser.add_argument('scenarios', metavar='scenario', type=str, nargs='*',
                     help='Scenario to run')
 
 parser.add_argument('-l', '--list', dest="list", action='store_true', default=False,
                     help='Get list of available scenarios')
 
-parser.add_argument('-s', '--simulate', dest="simulate", action='store_true', default=False,
-                    help='Run simulation and postprocessing (false by default)')
+parser.add_argument('-p', '--param', dest='params', type=parse_param, action='append',
+                    default=[], metavar='NAME=V1[,V2...]',
+                    help='Parameter to sweep. Any scenario command line option or NS-3 attribute')
+
+parser.add_argument('-r', '--runs', dest='runs', type=parse_runs, default=[1],
+                    help='RNG runs (seeds) of every parameter combination, e.g. 1-10 (default: 1)')
 
-parser.add_argument('-g', '--no-graph', dest="graph", action='store_false', default=True,
-                    help='Do not build a graph for the scenario (builds a graph by default)')
+parser.add_argument('-j', '--jobs', dest='jobs', type=int, default=os.cpu_count(),
+                    help='Maximum number of simultaneous simulations (default: number of cores)')
+
+parser.add_argument('-o', '--output', dest='output', default='results',
+                    help='Directory where job directories are created (default: results)')
+
+parser.add_argument('-c', '--route-cache', dest='route_cache', default=None, metavar='DIR',
+                    help='Directory where the scenarios cache their routes, shared by all the jobs '
+                    '(default: route-cache inside the output directory, empty to disable)')
+
+parser.add_argument('-f', '--force', dest='force', action='store_true', default=False,
+                    help='Run again jobs that already finished')
+
+parser.add_argument('-t', '--tsv', dest='tsv', action='store_true', default=False,
+                    help='Convert binary traces to tab separated files after each run')
+
+parser.add_argument('-n', '--dry-run', dest='dry_run', action='store_true', default=False,
+                    help='Only print the jobs that would be run')
 
 args = parser.parse_args()
 
-if not args.list and len(args.scenarios)==0:
-    print "ERROR: at least one scenario need to be specified"
+if args.list:
+    print("Available scenarios: ")
+    for scenario in available_scenarios():
+        print("    " + scenario)
+    sys.exit(0)
+
+if len(args.scenarios) == 0:
+    print("ERROR: at least one scenario need to be specified")
     parser.print_help()
-    exit (1)
+    sys.exit(1)
 
-if args.list:
-    print "Available scenarios: "
-else:
-    if args.simulate:
-        print "Simulating the following scenarios: " + ",".join (args.scenarios)
+if args.jobs < 1:
+    parser.error('--jobs must be positive')
 
-    if args.graph:
-        print "Building graphs for the following scenarios: " + ",".join (args.scenarios)
+if args.route_cache is None:
+    args.route_cache = os.path.join(args.output, 'route-cache')
+if args.route_cache:
+    # Jobs run inside their own directories
+    args.route_cache = os.path.abspath(args.route_cache)
 
 ######################################################################
 ######################################################################
 ######################################################################
 
-class SimulationJob (workerpool.Job):
-    "Job to simulate things"
-    def __init__ (self, cmdline):
-        self.cmdline = cmdline
-    def run (self):
-        print (" ".join (self.cmdline))
-        subprocess.call (self.cmdline)
-
-pool = workerpool.WorkerPool(size = multiprocessing.cpu_count())
-
-class Processor:
-    def run (self):
-        if args.list:
-            print "    " + self.name
-            return
-
-        if "all" not in args.scenarios and self.name not in args.scenarios:
-            return
-
-        if args.list:
-            pass
-        else:
-            if args.simulate:
-                self.simulate ()
-                pool.join ()
-                self.postprocess ()
-            if args.graph:
-                self.graph ()
-
-    def graph (self):
-        subprocess.call ("./graphs/%s.R" % self.name, shell=True)
-
-class Scenario (Processor):
-    def __init__ (self, name):
-        self.name = name
-        # other initialization, if any
-
-    def simulate (self):
-        cmdline = ["./build/SCENARIO_TO_RUN"]
-        job = SimulationJob (cmdline)
-        pool.put (job)
-
-    def postprocess (self):
-        # any postprocessing, if any
-        pass
+class Job:
+    "A single simulation: one scenario, one parameter combination and one RNG run"
 
-try:
-    # Simulation, processing, and graph building
-    fig = Scenario (name="NAME_TO_CONFIGURE")
-    fig.run ()
+    def __init__(self, scenario, params, run):
+        self.scenario = scenario
+        self.params = params
+        self.run = run
+
+        # Attribute paths such as ns3::ndn::ConsumerSrc::Beta are shortened to Beta
+        # for readability. The hash of the exact parameters keeps the directories
+        # of different parameter sets apart (e.g. ns3::A::Beta and ns3::B::Beta).
+        label = '_'.join('%s=%s' % (name.split('::')[-1], value) for name, value in params)
+        label = re.sub(r'[^\w.=+-]', '-', label) or 'default'
+        if params:
+            options = ' '.join('--%s=%s' % (name, value) for name, value in params)
+            label += '-' + hashlib.sha1(options.encode()).hexdigest()[:8]
+        self.directory = os.path.join(args.output, scenario, label, 'run-%d' % run)
+
+    def cmdline(self):
+        cmdline = [os.path.join(BUILD, self.scenario), '--RngRun=%d' % self.run]
+        if args.route_cache:
+            cmdline.append('--routeCache=%s' % args.route_cache)
+        cmdline += ['--%s=%s' % (name, value) for name, value in self.params]
+        return cmdline
 
+    def finished(self):
+        try:
+            with open(os.path.join(self.directory, 'status')) as status:
+                return status.read().strip() == '0'
+        except OSError:
+            return False
+
+    def execute(self):
+        os.makedirs(self.directory, exist_ok=True)
+        # Scenarios look for their default topology files in scenarios/
+        link = os.path.join(self.directory, 'scenarios')
+        if not os.path.lexists(link):
+            os.symlink(os.path.join(TOP, 'scenarios'), link)
+
+        status_file = os.path.join(self.directory, 'status')
+        if os.path.exists(status_file):
+            os.remove(status_file)
+
+        with open(os.path.join(self.directory, 'cmdline'), 'w') as out:
+            out.write(' '.join(self.cmdline()) + '\n')
+        with open(os.path.join(self.directory, 'stdout.log'), 'w') as out, \
+             open(os.path.join(self.directory, 'stderr.log'), 'w') as err:
+            code = subprocess.call(self.cmdline(), cwd=self.directory, stdout=out, stderr=err)
+
+        if code == 0 and args.tsv:
+            code = self.convert_traces()
+
+        with open(status_file, 'w') as status:
+            status.write('%d\n' % code)
+
+        return code
+
+    def convert_traces(self):
+        for trace in os.listdir(self.directory):
+            if trace.endswith('.bin'):
+                source = os.path.join(self.directory, trace)
+                code = subprocess.call([os.path.join(BUILD, 'trace-to-tsv'), source,
+                                        os.path.splitext(source)[0] + '.dat'])
+                if code != 0:
+                    return code
+        return 0
+
+class Progress:
+    "Aggregated progress report of the whole sweep"
+
+    def __init__(self, total):
+        self.total = total
+        self.done = 0
+        self.failed = 0
+        self.start = time.monotonic()
+        self.lock = threading.Lock()
+
+    def update(self, job, code):
+        with self.lock:
+            self.done += 1
+            if code != 0:
+                self.failed += 1
+            elapsed = time.monotonic() - self.start
+            eta = elapsed / self.done * (self.total - self.done)
+            print("[%d/%d] %s %s (failed: %d, elapsed: %s, ETA: %s)"
+                  % (self.done, self.total, 'FAILED' if code != 0 else 'done', job.directory,
+                     self.failed, format_time(elapsed), format_time(eta)), flush=True)
+
+def format_time(seconds):
+    seconds = int(seconds)
+    return '%d:%02d:%02d' % (seconds // 3600, seconds // 60 % 60, seconds % 60)
+
+def expand_jobs():
+    names = [name for name, _ in args.params]
+    grid = itertools.product(*[values for _, values in args.params])
+    combinations = [list(zip(names, values)) for values in grid]
+    return [Job(scenario, params, run)
+            for scenario in args.scenarios
+            for params in combinations
+            for run in args.runs]
+
+######################################################################
+######################################################################
+######################################################################
+
+unknown = [s for s in args.scenarios if s not in available_scenarios()]
+if unknown:
+    print("ERROR: unknown scenarios: " + ",".join(unknown))
+    sys.exit(1)
+
+jobs = expand_jobs()
+pending = [job for job in jobs if args.force or not job.finished()]
+print("%d jobs, %d already finished, running %d with %d workers"
+      % (len(jobs), len(jobs) - len(pending), len(pending), args.jobs))
+
+if args.dry_run:
+    for job in pending:
+        print("%s: %s" % (job.directory, ' '.join(job.cmdline())))
+    sys.exit(0)
+
+progress = Progress(len(pending))
+pool = concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs)
+futures = {}
+try:
+    futures = {pool.submit(job.execute): job for job in pending}
+    for future in concurrent.futures.as_completed(futures):
+        progress.update(futures[future], future.result())
+except KeyboardInterrupt:
+    print("Interrupted. Run the same command again to resume the sweep.")
+    for future in futures:
+        future.cancel()
+    sys.exit(1)
 finally:
-    pool.join ()
-    pool.shutdown ()
+    pool.shutdown()
+
+sys.exit(1 if progress.failed else 0)
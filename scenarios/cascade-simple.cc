@@ -25,6 +25,14 @@
 #include <ns3/point-to-point-module.h>
 
 #include "consumer-src.hpp"
+#include "flow-stats.hpp"
+#include "ladder-scheduler.hpp"
+#include "producer-fast.hpp"
+#include "queue-monitor.hpp"
+#include "replications.hpp"
+#include "route-cache.hpp"
+#include "run-profile.hpp"
+#include "trace-sink.hpp"
 
 #include <string>
 
@@ -33,26 +41,66 @@ using std::string;
 
 namespace {
 void
-queueChange(Ptr<OutputStreamWrapper> stream, uint32_t oldSize, uint32_t newSize)
+queueChange(Ptr<ndn::QueueMonitor> monitor, uint32_t queue, uint32_t oldSize, uint32_t newSize)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << oldSize << '\t' << newSize
-                       << std::endl;
+  monitor->OnChange(queue, oldSize, newSize);
 }
 
 void
-doubleValue(Ptr<OutputStreamWrapper> stream, const string& nodeName, double oldValue,
-            double newValue)
+doubleValue(Ptr<ndn::TraceSink> sink, uint32_t source, double oldValue, double newValue)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t' << oldValue
-                       << '\t' << newValue << std::endl;
+  sink->Write(source, oldValue, newValue);
 }
 
 void
-receivedData(Ptr<OutputStreamWrapper> stream, uint comm, shared_ptr<const ndn::Data> data,
+routerValue(Ptr<ndn::TraceSink> sink, uint32_t routerId, double value)
+{
+  sink->Write(routerId, value);
+}
+
+void
+routerDelay(Ptr<ndn::TraceSink> sink, uint32_t routerId, Time delay)
+{
+  sink->Write(routerId, delay.GetSeconds());
+}
+
+void
+congestionEvent(Ptr<ndn::TraceSink> sink, double window)
+{
+  sink->Write(0, window);
+}
+
+void
+timeout(Ptr<ndn::TraceSink> sink, uint32_t source, uint32_t sequenceNum, double window,
+        uint32_t inFlight)
+{
+  sink->Write(source, window, inFlight);
+}
+
+void
+receivedData(Ptr<ndn::TraceSink> sink, uint comm, shared_ptr<const ndn::Data> data,
              Ptr<ndn::App> app, shared_ptr<ndn::Face>)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << comm << '\t'
-                       << data->getContent().size() << std::endl;
+  sink->Write(comm, data->getContent().size());
+}
+
+void
+statsData(Ptr<ndn::FlowStats> stats, uint32_t flow, shared_ptr<const ndn::Data> data,
+          Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  stats->OnData(flow, data->getContent().size());
+}
+
+void
+statsAppDelay(Ptr<ndn::FlowStats> stats, Ptr<ndn::App>, uint32_t, Time delay, int32_t)
+{
+  stats->OnAppDelay(delay);
+}
+
+void
+statsQueueDelay(Ptr<ndn::FlowStats> stats, uint32_t, Time delay)
+{
+  stats->OnQueueDelay(delay);
 }
 
 } // namespace
@@ -60,10 +108,20 @@ receivedData(Ptr<OutputStreamWrapper> stream, uint comm, shared_ptr<const ndn::D
 auto
 main(int argc, char* argv[]) -> int
 {
+  ndn::RunProfile profile;
   string congProto = "SBINOM";
   string topologyFile = "scenarios/scenario-cascade.txt";
   Time lapse = Seconds(20);
   uint16_t payloadSize = 1450;
+  Time statsWindow = Seconds(1);
+  bool rawTraces = false;
+  Time queueInterval = MilliSeconds(10);
+  uint32_t queueThreshold = 0;
+  string profileFile;
+  string replications;
+  string routeCache;
+  string scheduler = "map";
+  unsigned jobs = 0;
 
   CommandLine cmd;
   cmd.Usage("Linear topology with a single source.\n"
@@ -72,24 +130,45 @@ main(int argc, char* argv[]) -> int
   cmd.AddValue("topoFile", "Topology description file", topologyFile);
   cmd.AddValue("lapse", "Time between start of communications", lapse);
   cmd.AddValue("payload", "Payload size in bytes", payloadSize);
+  cmd.AddValue("statsWindow", "Length of the throughput and fairness windows", statsWindow);
+  cmd.AddValue("rawTraces", "Also dump every received packet and its delay", rawTraces);
+  cmd.AddValue("queueInterval", "Length of the bins of the queue length summaries", queueInterval);
+  cmd.AddValue("queueThreshold", "Trace every change of the queues that reach this length",
+               queueThreshold);
+  cmd.AddValue("profile", "Write the setup and run times, event rate and peak memory (JSON)",
+               profileFile);
+  cmd.AddValue("replications",
+               "Run these RNG runs (e.g. 1-10), each in its own run-N directory, forking after "
+               "the setup",
+               replications);
+  cmd.AddValue("scheduler", "Event scheduler: map, heap, list, calendar or ladder", scheduler);
+  cmd.AddValue("routeCache", "Directory where the routes are cached between runs", routeCache);
+  cmd.AddValue("jobs", "Number of replications run at the same time (0 for one per core)", jobs);
   cmd.Parse(argc, argv);
+  ndn::SelectScheduler(scheduler);
 
   AnnotatedTopologyReader topologyReader("", 25);
   topologyReader.SetFileName(topologyFile);
   topologyReader.Read();
 
-  AsciiTraceHelper asciiTraceHelper;
+  // Traces are binary. Use the trace-to-tsv tool to convert them to text.
+  // Queue lengths are summarized in bins. Every single change is also written
+  // with rawTraces, or with queueThreshold while the queue is that long.
+  auto queues = Create<ndn::QueueMonitor>("queue-cascade-bins.dat", queueInterval);
+  if (rawTraces || queueThreshold > 0) {
+    auto detailSink =
+      Create<ndn::TraceSink>("queue-cascade.bin", 2, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    queues->SetDetail(detailSink, rawTraces ? 0 : queueThreshold);
+  }
+
   // Trace Src->Rtr queue length
   // FIXME: Check that we have selected the proper device
-  auto qSizeStream1 = asciiTraceHelper.CreateFileStream("queue-cascade-1.dat");
   Config::ConnectWithoutContext("Names/Rtr2/DeviceList/1/TxQueue/PacketsInQueue",
-                                MakeBoundCallback(&queueChange, qSizeStream1));
-  auto qSizeStream2 = asciiTraceHelper.CreateFileStream("queue-cascade-2.dat");
+                                MakeBoundCallback(&queueChange, queues, queues->AddQueue("1")));
   Config::ConnectWithoutContext("Names/Rtr3/DeviceList/2/TxQueue/PacketsInQueue",
-                                MakeBoundCallback(&queueChange, qSizeStream2));
-  auto qSizeStream3 = asciiTraceHelper.CreateFileStream("queue-cascade-3.dat");
+                                MakeBoundCallback(&queueChange, queues, queues->AddQueue("2")));
   Config::ConnectWithoutContext("Names/Src1/DeviceList/0/TxQueue/PacketsInQueue",
-                                MakeBoundCallback(&queueChange, qSizeStream3));
+                                MakeBoundCallback(&queueChange, queues, queues->AddQueue("3")));
 
   // Install NDN stack on all nodes
   ndn::StackHelper ndnHelper;
@@ -105,13 +184,28 @@ main(int argc, char* argv[]) -> int
   ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
   ndnGlobalRoutingHelper.InstallAll();
 
+  // Routes are only calculated the first time a topology is run with the same origins
+  ndn::RouteCache routes(topologyFile, routeCache);
+
   ndn::AppHelper consumerHelper("ns3::ndn::ConsumerSrc");
-  ndn::AppHelper producerHelper("ns3::ndn::Producer");
+  ndn::AppHelper producerHelper("ns3::ndn::ProducerFast");
   producerHelper.SetAttribute("PayloadSize", UintegerValue(payloadSize));
   auto producerNode = Names::Find<Node>("Src1");
+  // Per flow goodput, fairness and delays, without dumping every packet
+  auto stats = Create<ndn::FlowStats>(statsWindow);
+  Ptr<ndn::TraceSink> wSizeSink;
+  if (rawTraces) {
+    wSizeSink = Create<ndn::TraceSink>("src-size-cascade.bin", 1,
+                                       ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+  }
   // Trace window size
-  auto wsizetream = asciiTraceHelper.CreateFileStream("src-size-cascade.dat");
-  auto wStream = asciiTraceHelper.CreateFileStream("src-w-cascade.dat");
+  auto wSink = Create<ndn::TraceSink>("src-w-cascade.bin", 2, ndn::trace::HAS_SOURCE);
+  auto timeoutSink = Create<ndn::TraceSink>("timeouts-cascade.bin", 2, ndn::trace::HAS_SOURCE);
+  // Congestion information seen by the first consumer
+  auto rateSink =
+    Create<ndn::TraceSink>("rate-cascade.bin", 1, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+  auto delaySink = Create<ndn::TraceSink>("delay-cascade.bin", 1, ndn::trace::HAS_SOURCE);
+  auto congestionSink = Create<ndn::TraceSink>("congestion-cascade.bin", 1, 0);
   for (uint comm = 1; comm <= 4; comm++) {
     ostringstream consumerName;
     ostringstream producerName;
@@ -125,31 +219,73 @@ main(int argc, char* argv[]) -> int
     auto consumer = consumerHelper.Install(nodeName.str()).Get(0);
     // Source cannot start at 0.0 as nodes are not yet ready. First packet would get lost.
     if (comm == 1) {
-      consumer->SetAttribute("DumpCongestion", BooleanValue(true));
+      consumer->TraceConnectWithoutContext("RouterRate", MakeBoundCallback(&routerValue, rateSink));
+      consumer->TraceConnectWithoutContext("RouterDelay",
+                                           MakeBoundCallback(&routerDelay, delaySink));
+      consumer->TraceConnectWithoutContext("CongestionEvent",
+                                           MakeBoundCallback(&congestionEvent, congestionSink));
     }
     consumer->SetStartTime(lapse * (comm - 1) + NanoSeconds(1));
     consumer->SetStopTime(lapse * (4 + 4 - comm));
-    consumer->TraceConnectWithoutContext("WindowTrace", MakeBoundCallback(&doubleValue, wStream,
-                                                                          consumerName.str()));
-    consumer->TraceConnectWithoutContext("ReceivedDatas",
-                                         MakeBoundCallback(&receivedData, wsizetream, comm));
+    consumer->TraceConnectWithoutContext("WindowTrace",
+                                         MakeBoundCallback(&doubleValue, wSink,
+                                                           wSink->DefineSource(consumerName.str())));
+    consumer->TraceConnectWithoutContext(
+      "Timeout", MakeBoundCallback(&timeout, timeoutSink,
+                                   timeoutSink->DefineSource(consumerName.str())));
+    if (rawTraces) {
+      consumer->TraceConnectWithoutContext("ReceivedDatas",
+                                           MakeBoundCallback(&receivedData, wSizeSink, comm));
+    }
+    consumer->TraceConnectWithoutContext(
+      "ReceivedDatas", MakeBoundCallback(&statsData, stats, stats->AddFlow(consumerName.str())));
+    consumer->TraceConnectWithoutContext("LastRetransmittedInterestDataDelay",
+                                         MakeBoundCallback(&statsAppDelay, stats));
+    consumer->TraceConnectWithoutContext("RouterDelay",
+                                         MakeBoundCallback(&statsQueueDelay, stats));
 
-    ndnGlobalRoutingHelper.AddOrigins(producerName.str(), producerNode);
+    routes.AddOrigins(producerName.str(), producerNode);
     producerHelper.SetPrefix(producerName.str());
     producerHelper.Install(producerNode);
   }
 
-  ndn::AppDelayTracer::InstallAll("app-delay-cascade.dat");
-
   // Calculate and install FIBs
-  ndn::GlobalRoutingHelper::CalculateRoutes();
+  routes.CalculateRoutes();
+
+  // Everything above is shared by the replications, the rest is per run
+  if (!replications.empty()) {
+    ndn::ForkReplications(replications, jobs);
+  }
+
+  if (rawTraces) {
+    ndn::AppDelayTracer::InstallAll("app-delay-cascade.dat");
+  }
 
   Simulator::Stop(2 * 4 * lapse);
 
+  profile.StartRun();
   Simulator::Run();
+  profile.EndRun();
+
+  queues->Close();
+  wSink->Close();
+  timeoutSink->Close();
+  rateSink->Close();
+  delaySink->Close();
+  congestionSink->Close();
+  if (rawTraces) {
+    wSizeSink->Close();
+  }
+
+  stats->PrintSummary(std::cout);
+  stats->WriteTimeSeries("throughput-cascade.dat", "fairness-cascade.dat");
 
   Simulator::Destroy();
 
+  if (!profileFile.empty()) {
+    profile.Write(profileFile);
+  }
+
   return 0;
 }
 } // namespace ns3
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/ndnSIM-module.h>
+#include <ns3/network-module.h>
+#include <ns3/point-to-point-module.h>
+
+#include "consumer-src.hpp"
+#include "flow-spec.hpp"
+#include "flow-stats.hpp"
+#include "ladder-scheduler.hpp"
+#include "producer-fast.hpp"
+#include "queue-monitor.hpp"
+#include "replications.hpp"
+#include "route-cache.hpp"
+#include "run-profile.hpp"
+#include "trace-sink.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ns3 {
+using std::string;
+
+namespace {
+void
+queueChange(Ptr<ndn::QueueMonitor> monitor, uint32_t queue, uint32_t oldSize, uint32_t newSize)
+{
+  monitor->OnChange(queue, oldSize, newSize);
+}
+
+void
+rxTraffic(Ptr<ndn::TraceSink> sink, uint32_t source, Ptr<const Packet> packet)
+{
+  sink->Write(source, packet->GetSize() + 20 /* ip header */ + 16 /* Eth header */);
+}
+
+void
+doubleValue(Ptr<ndn::TraceSink> sink, uint32_t source, double oldValue, double newValue)
+{
+  sink->Write(source, oldValue, newValue);
+}
+
+void
+timeout(Ptr<ndn::TraceSink> sink, uint32_t source, uint32_t sequenceNum, double window,
+        uint32_t inFlight)
+{
+  sink->Write(source, window, inFlight);
+}
+
+void
+receivedData(Ptr<ndn::TraceSink> sink, uint32_t source, shared_ptr<const ndn::Data> data,
+             Ptr<ndn::App> app, shared_ptr<ndn::Face>)
+{
+  sink->Write(source, data->getContent().size());
+}
+
+auto
+findNode(const string& name) -> Ptr<Node>
+{
+  auto node = Names::Find<Node>(name);
+  NS_ABORT_MSG_IF(node == nullptr, "Unknown node " << name);
+
+  return node;
+}
+
+void
+statsData(Ptr<ndn::FlowStats> stats, uint32_t flow, shared_ptr<const ndn::Data> data,
+          Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  stats->OnData(flow, data->getContent().size());
+}
+
+void
+statsAppDelay(Ptr<ndn::FlowStats> stats, Ptr<ndn::App>, uint32_t, Time delay, int32_t)
+{
+  stats->OnAppDelay(delay);
+}
+
+void
+statsQueueDelay(Ptr<ndn::FlowStats> stats, uint32_t, Time delay)
+{
+  stats->OnQueueDelay(delay);
+}
+
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  ndn::RunProfile profile;
+  string topologyFile = "scenarios/scenario-simple.txt";
+  string flowFile = "scenarios/flows-simple.txt";
+  uint32_t payloadSize = 1024;
+  Time stopTime = Seconds(0);
+  Time statsWindow = Seconds(1);
+  bool rawTraces = false;
+  Time queueInterval = MilliSeconds(10);
+  uint32_t queueThreshold = 0;
+  string profileFile;
+  string replications;
+  string routeCache;
+  string scheduler = "map";
+  unsigned jobs = 0;
+
+  CommandLine cmd;
+  cmd.Usage("Scenario driven by a topology file and a flow specification file.\n"
+            "\n"
+            "See extensions/flow-spec.hpp for the format of the flow specification.\n");
+
+  cmd.AddValue("topoFile", "Topology description file", topologyFile);
+  cmd.AddValue("flowFile", "Flow specification file", flowFile);
+  cmd.AddValue("payloadSize", "Producers payload size", payloadSize);
+  cmd.AddValue("stop", "Simulation stop time. Defaults to the end of the last flow", stopTime);
+  cmd.AddValue("statsWindow", "Length of the throughput and fairness windows", statsWindow);
+  cmd.AddValue("rawTraces", "Also dump every received packet and its delay", rawTraces);
+  cmd.AddValue("queueInterval", "Length of the bins of the queue length summaries", queueInterval);
+  cmd.AddValue("queueThreshold", "Trace every change of the queues that reach this length",
+               queueThreshold);
+  cmd.AddValue("profile", "Write the setup and run times, event rate and peak memory (JSON)",
+               profileFile);
+  cmd.AddValue("replications",
+               "Run these RNG runs (e.g. 1-10), each in its own run-N directory, forking after "
+               "the setup",
+               replications);
+  cmd.AddValue("scheduler", "Event scheduler: map, heap, list, calendar or ladder", scheduler);
+  cmd.AddValue("routeCache", "Directory where the routes are cached between runs", routeCache);
+  cmd.AddValue("jobs", "Number of replications run at the same time (0 for one per core)", jobs);
+  cmd.Parse(argc, argv);
+  ndn::SelectScheduler(scheduler);
+
+  AnnotatedTopologyReader topologyReader("", 25);
+  topologyReader.SetFileName(topologyFile);
+  topologyReader.Read();
+
+  const ndn::FlowSpec spec(flowFile);
+
+  // Install NDN stack on all nodes
+  ndn::StackHelper ndnHelper;
+  ndnHelper.setPolicy("nfd::cs::lru");
+  ndnHelper.setCsSize(10);
+  ndnHelper.InstallAll();
+
+  // Choosing forwarding strategy
+  ndn::StrategyChoiceHelper::InstallAll("/", "/localhost/nfd/strategy/best-route");
+
+  // Installing global routing interface on all nodes
+  ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
+  ndnGlobalRoutingHelper.InstallAll();
+
+  // Routes are only calculated the first time a topology is run with the same origins
+  ndn::RouteCache routes(topologyFile, routeCache);
+
+  // Traces are binary. Use the trace-to-tsv tool to convert them to text.
+  // Devices are traced directly instead of through Config paths, as matching
+  // the paths walks every node of the topology.
+  // Queue lengths are summarized in bins. Every single change is also written
+  // with rawTraces, or with queueThreshold while the queue is that long.
+  auto queues = Create<ndn::QueueMonitor>("queue-bins.dat", queueInterval);
+  if (rawTraces || queueThreshold > 0) {
+    auto detailSink =
+      Create<ndn::TraceSink>("queue.bin", 2, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    queues->SetDetail(detailSink, rawTraces ? 0 : queueThreshold);
+  }
+  for (const auto& queue : spec.GetQueues()) {
+    auto node = findNode(queue.node);
+    NS_ABORT_MSG_IF(queue.device >= node->GetNDevices(),
+                    "Node " << queue.node << " has no device " << queue.device);
+    auto device = DynamicCast<PointToPointNetDevice>(node->GetDevice(queue.device));
+    NS_ABORT_MSG_IF(device == nullptr, "Device " << queue.device << " of node " << queue.node
+                                                 << " is not a point to point device");
+
+    device->GetQueue()->TraceConnectWithoutContext(
+      "PacketsInQueue",
+      MakeBoundCallback(&queueChange, queues,
+                        queues->AddQueue(queue.node + '/' + std::to_string(queue.device))));
+  }
+
+  // Per flow goodput, fairness and delays, without dumping every packet
+  auto stats = Create<ndn::FlowStats>(statsWindow);
+  Ptr<ndn::TraceSink> dataSink;
+  Ptr<ndn::TraceSink> wSizeSink;
+  if (rawTraces) {
+    dataSink =
+      Create<ndn::TraceSink>("recv_data.bin", 1, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    wSizeSink =
+      Create<ndn::TraceSink>("src-size.bin", 1, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+  }
+  auto wSink = Create<ndn::TraceSink>("src-w.bin", 2, ndn::trace::HAS_SOURCE);
+  auto timeoutSink = Create<ndn::TraceSink>("timeouts.bin", 2, ndn::trace::HAS_SOURCE);
+
+  ndn::AppHelper consumerHelper("ns3::ndn::ConsumerSrc");
+  ndn::AppHelper producerHelper("ns3::ndn::ProducerFast");
+  producerHelper.SetAttribute("PayloadSize", UintegerValue(payloadSize));
+
+  // Nodes are resolved once, and each producer and traced device is set up
+  // just once however many flows share it
+  std::unordered_map<string, Ptr<Node>> nodes;
+  auto getNode = [&nodes](const string& name) -> Ptr<Node> {
+    auto& node = nodes[name];
+    if (node == nullptr) {
+      node = findNode(name);
+    }
+    return node;
+  };
+  std::unordered_set<uint32_t> producers;
+  std::unordered_set<uint32_t> tracedConsumers;
+  NodeContainer consumerNodes;
+
+  uint32_t flowId = 0;
+  for (const auto& flow : spec.GetFlows()) {
+    auto consumerNode = getNode(flow.consumer);
+    auto producerNode = getNode(flow.producer);
+    const string prefix = '/' + flow.producer;
+    const string label = flow.consumer + '-' + flow.producer;
+
+    // Flows towards the same producer ask for different names so that they
+    // do not answer each other from the caches
+    consumerHelper.SetPrefix(prefix + '/' + std::to_string(flowId++));
+    auto consumer = consumerHelper.Install(consumerNode).Get(0);
+    for (const auto& attribute : flow.attributes) {
+      consumer->SetAttribute(attribute.first, StringValue(attribute.second));
+    }
+    // Source cannot start at 0.0 as nodes are not yet ready. First packet would
+    // get lost.
+    consumer->SetStartTime(flow.start + NanoSeconds(1));
+    consumer->SetStopTime(flow.stop);
+
+    consumer->TraceConnectWithoutContext("WindowTrace",
+                                         MakeBoundCallback(&doubleValue, wSink,
+                                                           wSink->DefineSource(label)));
+    consumer->TraceConnectWithoutContext("Timeout",
+                                         MakeBoundCallback(&timeout, timeoutSink,
+                                                           timeoutSink->DefineSource(label)));
+    consumer->TraceConnectWithoutContext(
+      "ReceivedDatas", MakeBoundCallback(&statsData, stats, stats->AddFlow(label)));
+    consumer->TraceConnectWithoutContext("LastRetransmittedInterestDataDelay",
+                                         MakeBoundCallback(&statsAppDelay, stats));
+    consumer->TraceConnectWithoutContext("RouterDelay",
+                                         MakeBoundCallback(&statsQueueDelay, stats));
+
+    if (rawTraces) {
+      consumer->TraceConnectWithoutContext("ReceivedDatas",
+                                           MakeBoundCallback(&receivedData, wSizeSink,
+                                                             wSizeSink->DefineSource(label)));
+
+      if (tracedConsumers.insert(consumerNode->GetId()).second) {
+        consumerNodes.Add(consumerNode);
+        consumerNode->GetDevice(0)->TraceConnectWithoutContext(
+          "MacRx",
+          MakeBoundCallback(&rxTraffic, dataSink, dataSink->DefineSource(flow.consumer)));
+      }
+    }
+
+    if (producers.insert(producerNode->GetId()).second) {
+      routes.AddOrigins(prefix, producerNode);
+      producerHelper.SetPrefix(prefix);
+      producerHelper.Install(producerNode);
+    }
+  }
+
+  // Calculate and install FIBs
+  routes.CalculateRoutes();
+
+  // Everything above is shared by the replications, the rest is per run
+  if (!replications.empty()) {
+    ndn::ForkReplications(replications, jobs);
+  }
+
+  if (rawTraces) {
+    ndn::AppDelayTracer::Install(consumerNodes, "app-delay.dat");
+  }
+
+  if (stopTime.IsZero()) {
+    stopTime = spec.GetStopTime();
+  }
+  cerr << "Flows: " << spec.GetFlows().size() << " Stop time: " << stopTime.GetSeconds() << 's'
+       << endl;
+  Simulator::Stop(stopTime);
+
+  profile.StartRun();
+  Simulator::Run();
+  profile.EndRun();
+
+  queues->Close();
+  wSink->Close();
+  timeoutSink->Close();
+  if (rawTraces) {
+    dataSink->Close();
+    wSizeSink->Close();
+  }
+
+  stats->PrintSummary(std::cout);
+  stats->WriteTimeSeries("throughput.dat", "fairness.dat");
+
+  Simulator::Destroy();
+
+  if (!profileFile.empty()) {
+    profile.Write(profileFile);
+  }
+
+  return 0;
+}
+} // namespace ns3
+
+auto
+main(int argc, char** argv) -> int
+{
+  return ns3::main(argc, argv);
+}
@@ -25,6 +25,14 @@
 #include <ns3/point-to-point-module.h>
 
 #include "consumer-src.hpp"
+#include "flow-stats.hpp"
+#include "ladder-scheduler.hpp"
+#include "producer-fast.hpp"
+#include "queue-monitor.hpp"
+#include "replications.hpp"
+#include "route-cache.hpp"
+#include "run-profile.hpp"
+#include "trace-sink.hpp"
 
 #include <string>
 
@@ -33,34 +41,54 @@ using std::string;
 
 namespace {
 void
-queueChange(Ptr<OutputStreamWrapper> stream, uint32_t oldSize, uint32_t newSize)
+queueChange(Ptr<ndn::QueueMonitor> monitor, uint32_t queue, uint32_t oldSize, uint32_t newSize)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << oldSize << '\t' << newSize
-                       << std::endl;
+  monitor->OnChange(queue, oldSize, newSize);
 }
 
 void
-rxTraffic(Ptr<OutputStreamWrapper> stream, const string& nodeName, Ptr<const Packet> packet)
+rxTraffic(Ptr<ndn::TraceSink> sink, uint32_t source, Ptr<const Packet> packet)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t'
-                       << packet->GetSize() + 20 /* ip header */ + 16 /* Eth header */
-                       << std::endl;
+  sink->Write(source, packet->GetSize() + 20 /* ip header */ + 16 /* Eth header */);
 }
 
 void
-doubleValue(Ptr<OutputStreamWrapper> stream, const string& nodeName, double oldValue,
-            double newValue)
+doubleValue(Ptr<ndn::TraceSink> sink, uint32_t source, double oldValue, double newValue)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t' << oldValue
-                       << '\t' << newValue << std::endl;
+  sink->Write(source, oldValue, newValue);
 }
 
 void
-receivedData(Ptr<OutputStreamWrapper> stream, shared_ptr<const ndn::Data> data, Ptr<ndn::App> app,
+timeout(Ptr<ndn::TraceSink> sink, uint32_t source, uint32_t sequenceNum, double window,
+        uint32_t inFlight)
+{
+  sink->Write(source, window, inFlight);
+}
+
+void
+receivedData(Ptr<ndn::TraceSink> sink, shared_ptr<const ndn::Data> data, Ptr<ndn::App> app,
              shared_ptr<ndn::Face>)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << app->GetId() << '\t'
-                       << data->getContent().size() << std::endl;
+  sink->Write(app->GetId(), data->getContent().size());
+}
+
+void
+statsData(Ptr<ndn::FlowStats> stats, uint32_t flow, shared_ptr<const ndn::Data> data,
+          Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  stats->OnData(flow, data->getContent().size());
+}
+
+void
+statsAppDelay(Ptr<ndn::FlowStats> stats, Ptr<ndn::App>, uint32_t, Time delay, int32_t)
+{
+  stats->OnAppDelay(delay);
+}
+
+void
+statsQueueDelay(Ptr<ndn::FlowStats> stats, uint32_t, Time delay)
+{
+  stats->OnQueueDelay(delay);
 }
 
 } // namespace
@@ -68,9 +96,19 @@ receivedData(Ptr<OutputStreamWrapper> stream, shared_ptr<const ndn::Data> data,
 auto
 main(int argc, char* argv[]) -> int
 {
+  ndn::RunProfile profile;
   string topologyFile = "scenarios/scenario-simple.txt";
   uint nComms = 4;
   Time lapse = Seconds(20);
+  Time statsWindow = Seconds(1);
+  bool rawTraces = false;
+  Time queueInterval = MilliSeconds(10);
+  uint32_t queueThreshold = 0;
+  string profileFile;
+  string replications;
+  string routeCache;
+  string scheduler = "map";
+  unsigned jobs = 0;
 
   CommandLine cmd;
   cmd.Usage("Linear topology with a n source.\n"
@@ -79,28 +117,56 @@ main(int argc, char* argv[]) -> int
   cmd.AddValue("topoFile", "Topology description file", topologyFile);
   cmd.AddValue("nComms", "Number of simultaneous communications", nComms);
   cmd.AddValue("lapse", "Time between start of communications", lapse);
+  cmd.AddValue("statsWindow", "Length of the throughput and fairness windows", statsWindow);
+  cmd.AddValue("rawTraces", "Also dump every received packet and its delay", rawTraces);
+  cmd.AddValue("queueInterval", "Length of the bins of the queue length summaries", queueInterval);
+  cmd.AddValue("queueThreshold", "Trace every change of the queues that reach this length",
+               queueThreshold);
+  cmd.AddValue("profile", "Write the setup and run times, event rate and peak memory (JSON)",
+               profileFile);
+  cmd.AddValue("replications",
+               "Run these RNG runs (e.g. 1-10), each in its own run-N directory, forking after "
+               "the setup",
+               replications);
+  cmd.AddValue("scheduler", "Event scheduler: map, heap, list, calendar or ladder", scheduler);
+  cmd.AddValue("routeCache", "Directory where the routes are cached between runs", routeCache);
+  cmd.AddValue("jobs", "Number of replications run at the same time (0 for one per core)", jobs);
   cmd.Parse(argc, argv);
+  ndn::SelectScheduler(scheduler);
 
   AnnotatedTopologyReader topologyReader("", 25);
   topologyReader.SetFileName(topologyFile);
   topologyReader.Read();
 
-  AsciiTraceHelper asciiTraceHelper;
+  // Traces are binary. Use the trace-to-tsv tool to convert them to text.
+  // Queue lengths are summarized in bins. Every single change is also written
+  // with rawTraces, or with queueThreshold while the queue is that long.
+  auto queues = Create<ndn::QueueMonitor>("queue-bins.dat", queueInterval);
+  if (rawTraces || queueThreshold > 0) {
+    auto detailSink =
+      Create<ndn::TraceSink>("queue.bin", 2, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    queues->SetDetail(detailSink, rawTraces ? 0 : queueThreshold);
+  }
+
   // Trace Src->Rtr queue length
-  auto qSizeStream = asciiTraceHelper.CreateFileStream("queue.dat");
   Config::ConnectWithoutContext("Names/R2/DeviceList/0/TxQueue/PacketsInQueue",
-                                MakeBoundCallback(&queueChange, qSizeStream));
+                                MakeBoundCallback(&queueChange, queues, queues->AddQueue("R2")));
 
   // Trace arriving data
-  auto dataStream = asciiTraceHelper.CreateFileStream("recv_data.dat");
-  for (uint comm = 1; comm <= nComms; comm++) {
-    ostringstream consumerMacRx;
-    ostringstream consumerName;
-
-    consumerName << 'C' << comm;
-    consumerMacRx << "Names/" << consumerName.str() << "/DeviceList/0/MacRx";
-    Config::ConnectWithoutContext(consumerMacRx.str(),
-                                  MakeBoundCallback(&rxTraffic, dataStream, consumerName.str()));
+  Ptr<ndn::TraceSink> dataSink;
+  if (rawTraces) {
+    dataSink =
+      Create<ndn::TraceSink>("recv_data.bin", 1, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    for (uint comm = 1; comm <= nComms; comm++) {
+      ostringstream consumerMacRx;
+      ostringstream consumerName;
+
+      consumerName << 'C' << comm;
+      consumerMacRx << "Names/" << consumerName.str() << "/DeviceList/0/MacRx";
+      Config::ConnectWithoutContext(consumerMacRx.str(),
+                                    MakeBoundCallback(&rxTraffic, dataSink,
+                                                      dataSink->DefineSource(consumerName.str())));
+    }
   }
 
   // Install NDN stack on all nodes
@@ -120,12 +186,22 @@ main(int argc, char* argv[]) -> int
   ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
   ndnGlobalRoutingHelper.InstallAll();
 
+  // Routes are only calculated the first time a topology is run with the same origins
+  ndn::RouteCache routes(topologyFile, routeCache);
+
   ndn::AppHelper consumerHelper("ns3::ndn::ConsumerSrc");
-  ndn::AppHelper producerHelper("ns3::ndn::Producer");
+  ndn::AppHelper producerHelper("ns3::ndn::ProducerFast");
   producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+  // Per flow goodput, fairness and delays, without dumping every packet
+  auto stats = Create<ndn::FlowStats>(statsWindow);
+  Ptr<ndn::TraceSink> wSizeSink;
+  if (rawTraces) {
+    wSizeSink =
+      Create<ndn::TraceSink>("src-size.bin", 1, ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+  }
   // Trace window size
-  auto wsizetream = asciiTraceHelper.CreateFileStream("src-size.dat");
-  auto wStream = asciiTraceHelper.CreateFileStream("src-w.dat");
+  auto wSink = Create<ndn::TraceSink>("src-w.bin", 2, ndn::trace::HAS_SOURCE);
+  auto timeoutSink = Create<ndn::TraceSink>("timeouts.bin", 2, ndn::trace::HAS_SOURCE);
   for (uint comm = 0; comm < nComms; comm++) {
     ostringstream consumerName;
     ostringstream producerName;
@@ -142,28 +218,65 @@ main(int argc, char* argv[]) -> int
     consumer->SetStartTime(lapse * comm + NanoSeconds(1));
     consumer->SetStopTime(lapse * (nComms + comm + 1));
 
-    consumer->TraceConnectWithoutContext("WindowTrace", MakeBoundCallback(&doubleValue, wStream,
-                                                                          consumerName.str()));
-    consumer->TraceConnectWithoutContext("ReceivedDatas",
-                                         MakeBoundCallback(&receivedData, wsizetream));
-
-    ndnGlobalRoutingHelper.AddOrigins(producerName.str(), producerNode);
+    consumer->TraceConnectWithoutContext("WindowTrace",
+                                         MakeBoundCallback(&doubleValue, wSink,
+                                                           wSink->DefineSource(consumerName.str())));
+    consumer->TraceConnectWithoutContext(
+      "Timeout", MakeBoundCallback(&timeout, timeoutSink,
+                                   timeoutSink->DefineSource(consumerName.str())));
+    if (rawTraces) {
+      consumer->TraceConnectWithoutContext("ReceivedDatas",
+                                           MakeBoundCallback(&receivedData, wSizeSink));
+    }
+    consumer->TraceConnectWithoutContext(
+      "ReceivedDatas",
+      MakeBoundCallback(&statsData, stats, stats->AddFlow(consumerName.str())));
+    consumer->TraceConnectWithoutContext("LastRetransmittedInterestDataDelay",
+                                         MakeBoundCallback(&statsAppDelay, stats));
+    consumer->TraceConnectWithoutContext("RouterDelay",
+                                         MakeBoundCallback(&statsQueueDelay, stats));
+
+    routes.AddOrigins(producerName.str(), producerNode);
     producerHelper.SetPrefix(producerName.str());
     producerHelper.Install(producerNode);
   }
 
-  ndn::AppDelayTracer::InstallAll("app-delay.dat");
-
   // Calculate and install FIBs
-  ndn::GlobalRoutingHelper::CalculateRoutes();
+  routes.CalculateRoutes();
+
+  // Everything above is shared by the replications, the rest is per run
+  if (!replications.empty()) {
+    ndn::ForkReplications(replications, jobs);
+  }
+
+  if (rawTraces) {
+    ndn::AppDelayTracer::InstallAll("app-delay.dat");
+  }
 
   cerr << "Stop time: " << (2 * lapse * nComms).GetSeconds() << 's' << endl;
   Simulator::Stop(2 * lapse * nComms);
 
+  profile.StartRun();
   Simulator::Run();
+  profile.EndRun();
+
+  queues->Close();
+  wSink->Close();
+  timeoutSink->Close();
+  if (rawTraces) {
+    dataSink->Close();
+    wSizeSink->Close();
+  }
+
+  stats->PrintSummary(std::cout);
+  stats->WriteTimeSeries("throughput.dat", "fairness.dat");
 
   Simulator::Destroy();
 
+  if (!profileFile.empty()) {
+    profile.Write(profileFile);
+  }
+
   return 0;
 }
 } // namespace ns3
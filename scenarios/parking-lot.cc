@@ -18,6 +18,7 @@
  */
 
 #include <ns3/core-module.h>
+#include <ns3/mpi-interface.h>
 #include <ns3/ndnSIM-module.h>
 #include <ns3/ndnSIM/NFD/daemon/face/face.hpp>
 #include <ns3/ndnSIM/NFD/daemon/face/generic-link-service.hpp>
@@ -25,7 +26,17 @@
 #include <ns3/point-to-point-module.h>
 
 #include "consumer-src.hpp"
-
+#include "flow-stats.hpp"
+#include "ladder-scheduler.hpp"
+#include "producer-fast.hpp"
+#include "queue-monitor.hpp"
+#include "replications.hpp"
+#include "route-cache.hpp"
+#include "run-profile.hpp"
+#include "topology-partition.hpp"
+#include "trace-sink.hpp"
+
+#include <cstdio>
 #include <sstream>
 #include <string>
 
@@ -34,35 +45,54 @@ using std::string;
 
 namespace {
 void
-queueChange(Ptr<OutputStreamWrapper> stream, const string& nodeName, uint32_t oldSize,
-            uint32_t newSize)
+queueChange(Ptr<ndn::QueueMonitor> monitor, uint32_t queue, uint32_t oldSize, uint32_t newSize)
+{
+  monitor->OnChange(queue, oldSize, newSize);
+}
+
+void
+rxTraffic(Ptr<ndn::TraceSink> sink, uint32_t source, Ptr<const Packet> packet)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t' << oldSize
-                       << '\t' << newSize << std::endl;
+  sink->Write(source, packet->GetSize() + 20 /* ip header */ + 16 /* Eth header */);
 }
 
 void
-rxTraffic(Ptr<OutputStreamWrapper> stream, const string& nodeName, Ptr<const Packet> packet)
+doubleValue(Ptr<ndn::TraceSink> sink, uint32_t source, double oldValue, double newValue)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t'
-                       << packet->GetSize() + 20 /* ip header */ + 16 /* Eth header */
-                       << std::endl;
+  sink->Write(source, oldValue, newValue);
 }
 
 void
-doubleValue(Ptr<OutputStreamWrapper> stream, const string& nodeName, double oldValue,
-            double newValue)
+timeout(Ptr<ndn::TraceSink> sink, uint32_t source, uint32_t sequenceNum, double window,
+        uint32_t inFlight)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << nodeName << '\t' << oldValue
-                       << '\t' << newValue << std::endl;
+  sink->Write(source, window, inFlight);
 }
 
 void
-receivedData(Ptr<OutputStreamWrapper> stream, shared_ptr<const ndn::Data> data, Ptr<ndn::App> app,
+receivedData(Ptr<ndn::TraceSink> sink, shared_ptr<const ndn::Data> data, Ptr<ndn::App> app,
              shared_ptr<ndn::Face>)
 {
-  *stream->GetStream() << Simulator::Now().GetSeconds() << '\t' << app->GetId() << '\t'
-                       << data->getContent().size() << std::endl;
+  sink->Write(app->GetId(), data->getContent().size());
+}
+
+void
+statsData(Ptr<ndn::FlowStats> stats, uint32_t flow, shared_ptr<const ndn::Data> data,
+          Ptr<ndn::App>, shared_ptr<ndn::Face>)
+{
+  stats->OnData(flow, data->getContent().size());
+}
+
+void
+statsAppDelay(Ptr<ndn::FlowStats> stats, Ptr<ndn::App>, uint32_t, Time delay, int32_t)
+{
+  stats->OnAppDelay(delay);
+}
+
+void
+statsQueueDelay(Ptr<ndn::FlowStats> stats, uint32_t, Time delay)
+{
+  stats->OnQueueDelay(delay);
 }
 
 } // namespace
@@ -70,9 +100,20 @@ receivedData(Ptr<OutputStreamWrapper> stream, shared_ptr<const ndn::Data> data,
 auto
 main(int argc, char* argv[]) -> int
 {
+  ndn::RunProfile profile;
   string topologyFile = "scenarios/scenario-parking-lot.txt";
   uint nComms = 16;
   Time lapse = Seconds(20);
+  Time statsWindow = Seconds(1);
+  bool rawTraces = false;
+  Time queueInterval = MilliSeconds(10);
+  uint32_t queueThreshold = 0;
+  string profileFile;
+  string replications;
+  string routeCache;
+  string scheduler = "map";
+  unsigned jobs = 0;
+  bool mpi = false;
 
   CommandLine cmd;
   cmd.Usage("Linear topology with a n source.\n"
@@ -81,60 +122,145 @@ main(int argc, char* argv[]) -> int
   cmd.AddValue("topoFile", "Topology description file", topologyFile);
   cmd.AddValue("nComms", "Number of simultaneous communications", nComms);
   cmd.AddValue("lapse", "Time between start of communications", lapse);
+  cmd.AddValue("statsWindow", "Length of the throughput and fairness windows", statsWindow);
+  cmd.AddValue("rawTraces", "Also dump every received packet and its delay", rawTraces);
+  cmd.AddValue("queueInterval", "Length of the bins of the queue length summaries", queueInterval);
+  cmd.AddValue("queueThreshold", "Trace every change of the queues that reach this length",
+               queueThreshold);
+  cmd.AddValue("profile", "Write the setup and run times, event rate and peak memory (JSON)",
+               profileFile);
+  cmd.AddValue("replications",
+               "Run these RNG runs (e.g. 1-10), each in its own run-N directory, forking after "
+               "the setup",
+               replications);
+  cmd.AddValue("scheduler", "Event scheduler: map, heap, list, calendar or ladder", scheduler);
+  cmd.AddValue("routeCache", "Directory where the routes are cached between runs", routeCache);
+  cmd.AddValue("jobs", "Number of replications run at the same time (0 for one per core)", jobs);
+  cmd.AddValue("mpi", "Split the routers among the MPI ranks", mpi);
   cmd.Parse(argc, argv);
+  NS_ABORT_MSG_IF(mpi && !replications.empty(), "Replications cannot be forked from MPI ranks");
+
+  uint32_t rank = 0;
+  uint32_t nRanks = 1;
+  if (mpi) {
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(&argc, &argv);
+    rank = MpiInterface::GetSystemId();
+    nRanks = MpiInterface::GetSize();
+  }
+  // After choosing the simulator, as this creates it
+  ndn::SelectScheduler(scheduler);
 
+  // Every rank builds the whole topology, but only simulates the nodes whose
+  // system ID is its rank. The router chain is cut into one segment per rank.
+  const ndn::TopologyPartition partition(topologyFile, nRanks);
   AnnotatedTopologyReader topologyReader("", 25);
-  topologyReader.SetFileName(topologyFile);
-  topologyReader.Read();
+  if (nRanks > 1) {
+    const string partitionedFile = "topology.rank" + std::to_string(rank) + ".txt";
+    partition.Write(partitionedFile);
+    topologyReader.SetFileName(partitionedFile);
+    topologyReader.Read();
+    std::remove(partitionedFile.c_str());
+  }
+  else {
+    topologyReader.SetFileName(topologyFile);
+    topologyReader.Read();
+  }
+
+  auto isLocal = [rank](Ptr<Node> node) { return node != nullptr && node->GetSystemId() == rank; };
+  NodeContainer localNodes;
+  for (auto node = NodeList::Begin(); node != NodeList::End(); node++) {
+    if (isLocal(*node)) {
+      localNodes.Add(*node);
+    }
+  }
+
+  // Each rank writes its own traces. Merge them with the trace-merge tool.
+  auto traceFile = [rank, nRanks](const string& name, const string& extension) {
+    return nRanks > 1 ? name + ".rank" + std::to_string(rank) + extension : name + extension;
+  };
+
+  // Traces are binary. Use the trace-to-tsv tool to convert them to text.
+  // Queue lengths are summarized in bins. Every single change is also written
+  // with rawTraces, or with queueThreshold while the queue is that long.
+  auto queues = Create<ndn::QueueMonitor>(traceFile("queue-bins", ".dat"), queueInterval);
+  if (rawTraces || queueThreshold > 0) {
+    auto detailSink = Create<ndn::TraceSink>(traceFile("queue", ".bin"), 2,
+                                             ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    queues->SetDetail(detailSink, rawTraces ? 0 : queueThreshold);
+  }
 
-  AsciiTraceHelper asciiTraceHelper;
   // Trace Src->Rtr queue lengths
-  auto qSizeStream = asciiTraceHelper.CreateFileStream("queue.dat");
   for (uint router = 1; router < 16; router++) {
     ostringstream routerName;
     ostringstream queuePath;
 
     routerName << "R" << router;
+    if (!isLocal(Names::Find<Node>(routerName.str()))) {
+      continue;
+    }
     queuePath << "Names/" << routerName.str() << "/DeviceList/0/TxQueue/PacketsInQueue";
     Config::ConnectWithoutContext(queuePath.str(),
-                                  MakeBoundCallback(&queueChange, qSizeStream, routerName.str()));
+                                  MakeBoundCallback(&queueChange, queues,
+                                                    queues->AddQueue(routerName.str())));
   }
 
   // Trace arriving data
-  auto dataStream = asciiTraceHelper.CreateFileStream("recv_data.dat");
-  for (uint comm = 1; comm <= 16; comm++) {
-    ostringstream consumerMacRx;
-    ostringstream consumerName;
-
-    consumerName << 'C' << comm;
-    consumerMacRx << "Names/" << consumerName.str() << "/DeviceList/0/MacRx";
-    Config::ConnectWithoutContext(consumerMacRx.str(),
-                                  MakeBoundCallback(&rxTraffic, dataStream, consumerName.str()));
+  Ptr<ndn::TraceSink> dataSink;
+  if (rawTraces) {
+    dataSink = Create<ndn::TraceSink>(traceFile("recv_data", ".bin"), 1,
+                                      ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+    for (uint comm = 1; comm <= 16; comm++) {
+      ostringstream consumerMacRx;
+      ostringstream consumerName;
+
+      consumerName << 'C' << comm;
+      if (!isLocal(Names::Find<Node>(consumerName.str()))) {
+        continue;
+      }
+      consumerMacRx << "Names/" << consumerName.str() << "/DeviceList/0/MacRx";
+      Config::ConnectWithoutContext(consumerMacRx.str(),
+                                    MakeBoundCallback(&rxTraffic, dataSink,
+                                                      dataSink->DefineSource(consumerName.str())));
+    }
   }
 
-  // Install NDN stack on all nodes
+  // Install NDN stack on the local nodes
   ndn::StackHelper ndnHelper;
   ndnHelper.setPolicy("nfd::cs::lru");
   ndnHelper.setCsSize(10); // We do not need a big CS store for this simulation.
                            // In fact, 1 should do it.
-  ndnHelper.InstallAll();
+  ndnHelper.Install(localNodes);
 
   // Set the correct CoDEL threshold value for the queue to be 5ms
   // Simulator::Schedule(Seconds(0), changeQueueTarget, "Rtr1", 50000000);
 
   // Choosing forwarding strategy
-  ndn::StrategyChoiceHelper::InstallAll("/prefix", "/localhost/nfd/strategy/best-route");
+  ndn::StrategyChoiceHelper::Install(localNodes, "/prefix", "/localhost/nfd/strategy/best-route");
 
   // Installing global routing interface on all nodes
   ndn::GlobalRoutingHelper ndnGlobalRoutingHelper;
-  ndnGlobalRoutingHelper.InstallAll();
+  if (nRanks == 1) {
+    ndnGlobalRoutingHelper.InstallAll();
+  }
+
+  // Routes are only calculated the first time a topology is run with the same origins
+  ndn::RouteCache routes(topologyFile, routeCache);
 
   ndn::AppHelper consumerHelper("ns3::ndn::ConsumerSrc");
-  ndn::AppHelper producerHelper("ns3::ndn::Producer");
+  ndn::AppHelper producerHelper("ns3::ndn::ProducerFast");
   producerHelper.SetAttribute("PayloadSize", StringValue("1024"));
+  // Per flow goodput, fairness and delays, without dumping every packet
+  auto stats = Create<ndn::FlowStats>(statsWindow);
+  Ptr<ndn::TraceSink> wSizeSink;
+  if (rawTraces) {
+    wSizeSink = Create<ndn::TraceSink>(traceFile("src-size", ".bin"), 1,
+                                       ndn::trace::HAS_SOURCE | ndn::trace::INTEGRAL);
+  }
   // Trace window size
-  auto wsizetream = asciiTraceHelper.CreateFileStream("src-size.dat");
-  auto wStream = asciiTraceHelper.CreateFileStream("src-w.dat");
+  auto wSink = Create<ndn::TraceSink>(traceFile("src-w", ".bin"), 2, ndn::trace::HAS_SOURCE);
+  auto timeoutSink =
+    Create<ndn::TraceSink>(traceFile("timeouts", ".bin"), 2, ndn::trace::HAS_SOURCE);
   for (uint comm = 0; comm < nComms; comm++) {
     ostringstream consumerName;
     ostringstream producerName;
@@ -143,36 +269,102 @@ main(int argc, char* argv[]) -> int
     auto producerNode = Names::Find<Node>(producerName.str());
 
     consumerName << "C" << comm + 1;
+    auto consumerNode = Names::Find<Node>(consumerName.str());
+
+    if (nRanks == 1) {
+      routes.AddOrigins(producerName.str(), producerNode);
+    }
+    else {
+      // The global routing helper needs the stack on every node, so use the
+      // shortest paths of the topology file instead
+      for (const auto& hop : partition.GetNextHops(producerName.str())) {
+        auto node = Names::Find<Node>(hop.first);
+        if (isLocal(node)) {
+          ndn::FibHelper::AddRoute(node, producerName.str(), Names::Find<Node>(hop.second), 1);
+        }
+      }
+    }
+
+    if (isLocal(producerNode)) {
+      producerHelper.SetPrefix(producerName.str());
+      producerHelper.Install(producerNode);
+    }
+
+    if (!isLocal(consumerNode)) {
+      continue;
+    }
 
     consumerHelper.SetPrefix(producerName.str());
-    auto consumer = consumerHelper.Install(consumerName.str()).Get(0);
+    auto consumer = consumerHelper.Install(consumerNode).Get(0);
     // Source cannot start at 0.0 as nodes are not yet ready. First packet would
     // get lost.
     consumer->SetStartTime(lapse * comm + NanoSeconds(1));
     consumer->SetStopTime(lapse * (nComms + comm + 1));
 
-    consumer->TraceConnectWithoutContext("WindowTrace", MakeBoundCallback(&doubleValue, wStream,
-                                                                          consumerName.str()));
-    consumer->TraceConnectWithoutContext("ReceivedDatas",
-                                         MakeBoundCallback(&receivedData, wsizetream));
+    consumer->TraceConnectWithoutContext("WindowTrace",
+                                         MakeBoundCallback(&doubleValue, wSink,
+                                                           wSink->DefineSource(consumerName.str())));
+    consumer->TraceConnectWithoutContext(
+      "Timeout", MakeBoundCallback(&timeout, timeoutSink,
+                                   timeoutSink->DefineSource(consumerName.str())));
+    if (rawTraces) {
+      consumer->TraceConnectWithoutContext("ReceivedDatas",
+                                           MakeBoundCallback(&receivedData, wSizeSink));
+    }
+    consumer->TraceConnectWithoutContext(
+      "ReceivedDatas",
+      MakeBoundCallback(&statsData, stats, stats->AddFlow(consumerName.str())));
+    consumer->TraceConnectWithoutContext("LastRetransmittedInterestDataDelay",
+                                         MakeBoundCallback(&statsAppDelay, stats));
+    consumer->TraceConnectWithoutContext("RouterDelay",
+                                         MakeBoundCallback(&statsQueueDelay, stats));
+  }
 
-    ndnGlobalRoutingHelper.AddOrigins(producerName.str(), producerNode);
-    producerHelper.SetPrefix(producerName.str());
-    producerHelper.Install(producerNode);
+  // Calculate and install FIBs
+  if (nRanks == 1) {
+    routes.CalculateRoutes();
   }
 
-  ndn::AppDelayTracer::InstallAll("app-delay.dat");
+  // Everything above is shared by the replications, the rest is per run
+  if (!replications.empty()) {
+    ndn::ForkReplications(replications, jobs);
+  }
 
-  // Calculate and install FIBs
-  ndn::GlobalRoutingHelper::CalculateRoutes();
+  if (rawTraces) {
+    ndn::AppDelayTracer::Install(localNodes, traceFile("app-delay", ".dat"));
+  }
 
-  cerr << "Stop time: " << (2 * lapse * nComms).GetSeconds() << 's' << endl;
+  if (rank == 0) {
+    cerr << "Stop time: " << (2 * lapse * nComms).GetSeconds() << 's' << endl;
+  }
   Simulator::Stop(2 * lapse * nComms);
 
+  profile.StartRun();
   Simulator::Run();
+  profile.EndRun();
+
+  queues->Close();
+  wSink->Close();
+  timeoutSink->Close();
+  if (rawTraces) {
+    dataSink->Close();
+    wSizeSink->Close();
+  }
+
+  // With MPI each rank only sees its own flows
+  stats->PrintSummary(std::cout);
+  stats->WriteTimeSeries(traceFile("throughput", ".dat"), traceFile("fairness", ".dat"));
 
   Simulator::Destroy();
 
+  if (!profileFile.empty()) {
+    profile.Write(profileFile);
+  }
+
+  if (mpi) {
+    MpiInterface::Disable();
+  }
+
   return 0;
 }
 } // namespace ns3
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Merges binary traces of the same kind (e.g. those written by each MPI rank)
+ * into a single trace ordered by time:
+ *
+ *   trace-merge queue.bin queue.rank0.bin queue.rank1.bin...
+ *
+ * Named sources are renumbered so that each name keeps a single identifier.
+ * Unnamed sources keep their identifiers.
+ */
+
+#include "trace-record.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trace = ns3::ndn::trace;
+
+namespace {
+class Input {
+public:
+  explicit Input(const std::string& fileName)
+    : m_fileName(fileName)
+    , m_in(fileName, std::ios::binary)
+    , m_header{}
+  {
+  }
+
+  auto
+  ReadHeader() -> bool
+  {
+    if (!m_in) {
+      std::cerr << "Cannot open " << m_fileName << std::endl;
+      return false;
+    }
+    if (!m_in.read(reinterpret_cast<char*>(&m_header), sizeof(m_header))
+        || std::memcmp(m_header.magic, trace::MAGIC, sizeof(m_header.magic)) != 0
+        || m_header.version != trace::VERSION) {
+      std::cerr << m_fileName << " is not a supported trace file" << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  auto
+  GetHeader() const -> const trace::FileHeader&
+  {
+    return m_header;
+  }
+
+  auto
+  GetFileName() const -> const std::string&
+  {
+    return m_fileName;
+  }
+
+  /* Reads the next sample into record. Source names found on the way are
+   * reported to onName, always before any sample of that source. */
+  auto
+  Next(trace::Record& record, const std::function<void(uint32_t, const std::string&)>& onName)
+    -> bool
+  {
+    while (m_in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+      if (record.flags != trace::NAME) {
+        return true;
+      }
+
+      const size_t length = record.time;
+      const size_t padded = (length + sizeof(record) - 1) / sizeof(record) * sizeof(record);
+      std::string name(padded, '\0');
+      if (!m_in.read(&name[0], padded)) {
+        return false;
+      }
+      name.resize(length);
+      onName(record.source, name);
+    }
+
+    return false;
+  }
+
+private:
+  std::string m_fileName;
+  std::ifstream m_in;
+  trace::FileHeader m_header;
+};
+
+void
+writeName(std::ostream& out, uint32_t source, const std::string& name)
+{
+  trace::Record record{};
+  record.time = name.size();
+  record.source = source;
+  record.flags = trace::NAME;
+  out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+
+  std::string padded(name);
+  padded.resize((name.size() + sizeof(record) - 1) / sizeof(record) * sizeof(record), '\0');
+  out.write(padded.data(), padded.size());
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " OUTPUT TRACE..." << std::endl;
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<Input>> inputs;
+  for (int i = 2; i < argc; i++) {
+    inputs.emplace_back(new Input(argv[i]));
+    if (!inputs.back()->ReadHeader()) {
+      return 1;
+    }
+
+    const auto& first = inputs.front()->GetHeader();
+    const auto& header = inputs.back()->GetHeader();
+    if (header.nValues != first.nValues || header.flags != first.flags) {
+      std::cerr << argv[i] << " does not hold the same kind of samples as " << argv[2]
+                << std::endl;
+      return 1;
+    }
+  }
+
+  std::ofstream out(argv[1], std::ios::binary);
+  if (!out) {
+    std::cerr << "Cannot create " << argv[1] << std::endl;
+    return 1;
+  }
+  const trace::FileHeader header = inputs.front()->GetHeader();
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  // Identifiers of the named sources of each input in the merged trace
+  std::unordered_map<std::string, uint32_t> mergedIds;
+  std::vector<std::unordered_map<uint32_t, uint32_t>> sourceMaps(inputs.size());
+
+  auto onName = [&](size_t input) {
+    return [&, input](uint32_t source, const std::string& name) {
+      const auto inserted = mergedIds.emplace(name, mergedIds.size());
+      if (inserted.second) {
+        writeName(out, inserted.first->second, name);
+      }
+      sourceMaps[input][source] = inserted.first->second;
+    };
+  };
+
+  // Heads of the inputs, oldest first (and in input order on ties)
+  using Head = std::pair<trace::Record, size_t>;
+  auto later = [](const Head& a, const Head& b) {
+    return a.first.time != b.first.time ? a.first.time > b.first.time : a.second > b.second;
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    trace::Record record;
+    if (inputs[i]->Next(record, onName(i))) {
+      heads.emplace(record, i);
+    }
+  }
+
+  while (!heads.empty()) {
+    Head head = heads.top();
+    heads.pop();
+
+    const auto& sources = sourceMaps[head.second];
+    const auto source = sources.find(head.first.source);
+    if (source != sources.end()) {
+      head.first.source = source->second;
+    }
+    out.write(reinterpret_cast<const char*>(&head.first), sizeof(head.first));
+
+    trace::Record record;
+    if (inputs[head.second]->Next(record, onName(head.second))) {
+      heads.emplace(record, head.second);
+    }
+  }
+
+  return out ? 0 : 1;
+}
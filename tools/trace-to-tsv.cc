@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2020-2023 Universidade de Vigo
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Author: Miguel Rodríguez Pérez <miguel@det.uvigo.gal>
+ */
+
+/* Converts a binary trace written by TraceSink to the tab separated format
+ * the scenarios used to produce:
+ *
+ *   trace-to-tsv queue.bin [queue.dat]
+ */
+
+#include "trace-record.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trace = ns3::ndn::trace;
+
+namespace {
+auto
+convert(std::istream& in, std::ostream& out) -> bool
+{
+  trace::FileHeader header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || std::memcmp(header.magic, trace::MAGIC, sizeof(header.magic)) != 0) {
+    std::cerr << "Not a trace file" << std::endl;
+    return false;
+  }
+  if (header.version != trace::VERSION) {
+    std::cerr << "Unsupported trace version " << header.version << std::endl;
+    return false;
+  }
+
+  const bool hasSource = (header.flags & trace::HAS_SOURCE) != 0;
+  const bool integral = (header.flags & trace::INTEGRAL) != 0;
+
+  std::unordered_map<uint32_t, std::string> names;
+  std::vector<trace::Record> records(1U << 16);
+
+  // Name being read, as names span several records
+  std::string* name = nullptr;
+  size_t nameLength = 0;
+
+  while (in) {
+    in.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(trace::Record));
+    const size_t nRecords = in.gcount() / sizeof(trace::Record);
+
+    for (size_t i = 0; i < nRecords; i++) {
+      const trace::Record& record = records[i];
+
+      if (name != nullptr) {
+        const size_t chunk = std::min(nameLength - name->size(), sizeof(record));
+        name->append(reinterpret_cast<const char*>(&record), chunk);
+        if (name->size() == nameLength) {
+          name = nullptr;
+        }
+        continue;
+      }
+
+      if (record.flags == trace::NAME) {
+        name = &names[record.source];
+        name->clear();
+        nameLength = record.time;
+        if (nameLength == 0) {
+          name = nullptr;
+        }
+        continue;
+      }
+
+      out << record.time / 1e9;
+      if (hasSource) {
+        const auto source = names.find(record.source);
+        if (source != names.end()) {
+          out << '\t' << source->second;
+        }
+        else {
+          out << '\t' << record.source;
+        }
+      }
+      for (uint8_t v = 0; v < header.nValues; v++) {
+        if (integral) {
+          out << '\t' << static_cast<int64_t>(record.values[v]);
+        }
+        else {
+          out << '\t' << record.values[v];
+        }
+      }
+      out << '\n';
+    }
+  }
+
+  return true;
+}
+} // namespace
+
+auto
+main(int argc, char* argv[]) -> int
+{
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " TRACE [OUTPUT]" << std::endl;
+    return 1;
+  }
+
+  std::ifstream in(argv[1], std::ios::binary);
+  if (!in) {
+    std::cerr << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+
+  if (argc == 3) {
+    std::ofstream out(argv[2]);
+    if (!out) {
+      std::cerr << "Cannot create " << argv[2] << std::endl;
+      return 1;
+    }
+    return convert(in, out) ? 0 : 1;
+  }
+
+  return convert(in, std::cout) ? 0 : 1;
+}